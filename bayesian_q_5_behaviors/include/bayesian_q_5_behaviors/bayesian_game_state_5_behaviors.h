@@ -2,6 +2,13 @@
 #define BAYESIAN_GAME_STATE_H
 
 #include "q_learning_pacman/game_state.h"
+#include "q_learning_pacman/step_context.h"
+#include "pacman_abstract_classes/observation_engine.h"
+#include "pacman_abstract_classes/belief_support.h"
+#include "pacman_abstract_classes/distance_matrix.h"
+#include "pacman_abstract_classes/ball_index.h"
+#include "pacman_abstract_classes/task_scheduler.h"
+#include "pacman_abstract_classes/food_belief.h"
 
 #include "geometry_msgs/Pose.h"
 #include "pacman_msgs/AgentPoseService.h"
@@ -13,6 +20,10 @@
  */
 class BayesianGameState : public GameState
 {
+  public:
+    // QUANTIZED_BELIEFS keeps agent beliefs in bfloat16 and food in fixed point, see ProbabilityGrid
+    typedef enum {FLOAT_BELIEFS, QUANTIZED_BELIEFS} BeliefStorage;
+
   protected:
     void observeGhost(double measurement_x_dist, double measurement_y_dist, int ghost_index);
     void observePacman(double measurement_x, double measurement_y);
@@ -22,14 +33,116 @@ class BayesianGameState : public GameState
     ros::ServiceServer pacman_observer_service_;
     ros::ServiceServer ghost_distance_observer_service_;
 
+    // runs the per ghost observations of a tick in parallel
+    TaskScheduler task_scheduler_;
+    std::vector< ObservationEngine > ghost_distance_observation_engines_;
+
+    // cell storage of the agent and food beliefs, kernels read and write them through get and set
+    // and accumulate in float, so next_pose_map_ and the stacked ghost buffers stay float
+    ProbabilityGrid::Storage agents_storage_;
+    ProbabilityGrid::Storage foods_storage_;
+    // converts the live and initial beliefs to the storage of this state
+    void convertBeliefs();
+
+    // cells with non zero probability in each belief, updates only iterate over them
+    BeliefSupport pacman_support_;
+    std::vector< BeliefSupport > ghosts_supports_;
+    // zeroed buffer predictions are written into before being swapped with the belief
+    ProbabilityGrid next_pose_map_;
+    BeliefSupport next_support_;
+    void swapWithNextPoseMap(ProbabilityGrid& pose_map, BeliefSupport& support,
+                                ProbabilityGrid& next_pose_map, BeliefSupport& next_support);
+    // belief updates without bookkeeping, each one only writes its own agent
+    void predictPacmanBelief(pacman_msgs::PacmanAction action);
+    // predicts ghosts [begin_ghost, end_ghost) together, bands of ghosts can be predicted in parallel
+    void predictGhostsBeliefs(int begin_ghost, int end_ghost);
+    // zeroed cells x ghosts buffers, with the cells of the rows in use
+    struct StackedGhostsBeliefs
+    {
+        std::vector<float> beliefs;
+        std::vector<float> next_beliefs;
+        BeliefSupport support;
+        BeliefSupport next_support;
+    };
+    // buffers of the band that starts at each ghost
+    std::vector< StackedGhostsBeliefs > stacked_ghosts_beliefs_;
+    void redistributeProbability(ProbabilityGrid& pose_map, BeliefSupport& support);
+
+    // observation steps shared by the single agent and the batched observations
+    void applyPacmanObservation(double measurement_x, double measurement_y);
+    void applyGhostObservation(double measurement_x_dist, double measurement_y_dist, int ghost_index);
+    // per column and per row pacman measurement weights, filled once per observation
+    std::vector<double> pacman_measurement_x_weights_;
+    std::vector<double> pacman_measurement_y_weights_;
+    // false if the belief has no probability left, otherwise prunes and normalizes it and finds its most probable cell
+    bool normalizeBelief(ProbabilityGrid& pose_map, BeliefSupport& support, float sum_probabilities,
+                                int& most_probable_cell, double& pruned_mass);
+
+    // cells with less probability than this (relative to their belief's total) are zeroed after every
+    // prediction and observation, see BeliefSupport::prune, 0 disables it
+    float pruning_threshold_;
+    // fractions of pacman (first) and each ghost belief pruned since the tick started, one slot per parallel task
+    std::vector<double> pruned_masses_;
+    // pacman support cells and probabilities, gathered once and read by every ghost observation
+    std::vector<int> pacman_support_xs_;
+    std::vector<int> pacman_support_ys_;
+    std::vector<float> pacman_support_probabilities_;
+    void gatherPacmanSupport();
+
+    // most probable cells and max food probabilities, recalculated only after their beliefs change
+    bool is_pacman_most_probable_cell_valid_;
+    int pacman_most_probable_cell_;
+    // char instead of bool, so ghosts running in parallel write separate bytes
+    std::vector<char> is_ghost_most_probable_cell_valid_;
+    std::vector<int> ghosts_most_probable_cells_;
+    bool is_max_food_probability_valid_;
+    float max_food_probability_;
+    bool is_max_big_food_probability_valid_;
+    float max_big_food_probability_;
+    void invalidateSummaries();
+    // after the beliefs are replaced wholesale, also rebuilds the food indexes
+    void rebuildSupports();
+
+    // foods_map_ and big_foods_map_ indexed by certainty, kept in sync where pacman eats
+    FoodBelief food_belief_;
+    FoodBelief big_food_belief_;
+    // true if cell comes before other_cell in a sweep by x and then y, the order most probable cells have always been taken in
+    bool isSweptBefore(int cell, int other_cell);
+    int findMostProbableCell(const ProbabilityGrid& pose_map, BeliefSupport& support);
+    geometry_msgs::Pose getCellPose(int cell);
+
     // precalculate all real distances in map
-    std::map< std::pair<int, int>, std::map< std::pair<int, int>, int > > precalculated_distances_;
-    std::map< std::pair<int, int>, int > calculateDistances(int x, int y);
+    DistanceMatrix distance_matrix_;
+    std::vector<bool> open_cells_;
     void precalculateAllDistances();
 
+    // cells closer than n to each cell, indexed by n and built the first time n is used
+    std::vector< BallIndex > ball_indexes_;
+    const BallIndex& getBallIndex(int n);
+    std::vector<double> ghosts_white_probabilities_;
+
+    // values shared by the learner and the behaviors in the current tick
+    StepContext<BayesianGameState> step_context_;
+
   public:
-    BayesianGameState();
+    BayesianGameState(BeliefStorage belief_storage = FLOAT_BELIEFS);
     ~BayesianGameState();
+
+    void reset();
+    // also convert the belief to the storage of this state and rebuild its support or food index
+    void setPacmanPoseMap(const ProbabilityGrid& pacman_pose_map);
+    void setGhostPoseMap(const ProbabilityGrid& ghost_pose_map, int ghost_index);
+    void setFoodMap(const ProbabilityGrid& foods_map);
+    void setBigFoodMap(const ProbabilityGrid& big_foods_map);
+
+    void setPruningThreshold(float pruning_threshold);
+    float getPruningThreshold();
+    // probability mass pruned since the last pacman prediction started a tick
+    double getPrunedMass();
+
+    // observes pacman and then every ghost (offsets to pacman, in ghost order) of a tick at once
+    void observeAgents(double pacman_measurement_x, double pacman_measurement_y,
+                                const std::vector< std::pair<double, double> >& ghosts_measurements);
     
     void predictPacmanMove(pacman_msgs::PacmanAction action);
     void predictGhostMove(int ghost_index);
@@ -40,6 +153,9 @@ class BayesianGameState : public GameState
     bool isFinished();
     float getClosestFoodDistance();
     float getClosestBigFoodDistance();
+    // cells of the closest (big) food with at least half the max probability, -1 if none is closer than max_distance
+    int findClosestFoodCell(int max_distance, int& min_distance);
+    int findClosestBigFoodCell(int max_distance, int& min_distance);
     bool eatsFood(pacman_msgs::PacmanAction action);
     int getClosestGhostDistance();
     int getNumberOfGhostsOneStepAway(pacman_msgs::PacmanAction action);
@@ -59,7 +175,8 @@ class BayesianGameState : public GameState
     std::vector< geometry_msgs::Pose > getMostProbableGhostsPoses();
 
     // usefull functions
-    std::map< std::pair<int, int>, int > getDistances(int x, int y);
+    const DistanceMatrix& getDistanceMatrix();
+    StepContext<BayesianGameState>& getStepContext();
 };
 
 #endif // BAYESIAN_GAME_STATE_H
\ No newline at end of file
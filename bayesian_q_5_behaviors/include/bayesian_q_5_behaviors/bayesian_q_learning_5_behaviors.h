@@ -45,7 +45,9 @@ class BayesianQLearning
 
     void saveTempFeatures(int behavior);
 
-    std::vector<double> getFeatures(BayesianGameState *game_state, int behavior);
+    // features do not depend on the behavior, so they are calculated once per tick and kept in the step context
+    std::vector<double> calculateFeatures(BayesianGameState *game_state);
+    const std::vector<double>& getFeatures(BayesianGameState *game_state, int behavior);
     double getQValue(BayesianGameState *game_state, int behavior);
 
   public:
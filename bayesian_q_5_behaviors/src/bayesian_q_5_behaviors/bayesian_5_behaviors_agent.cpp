@@ -48,17 +48,19 @@ std::string BayesianBehaviorAgent::getAgentName()
 }
 
 pacman_msgs::PacmanAction BayesianBehaviorAgent::getHuntAction(BayesianGameState *game_state) {
-    geometry_msgs::Pose pacman_pose = game_state->getMostProbablePacmanPose();
-    std::map< std::pair<int, int>, int > distances = game_state->getDistances(pacman_pose.position.x, pacman_pose.position.y);
+    StepContext<BayesianGameState>& step_context = game_state->getStepContext();
+    const geometry_msgs::Pose& pacman_pose = step_context.getPacmanPose();
+    const DistanceMatrix& distance_matrix = game_state->getDistanceMatrix();
+    const uint16_t *distances = step_context.getPacmanDistances();
 
     int min_distance = util::MAX_DISTANCE;
 
-    std::vector< geometry_msgs::Pose > ghosts_poses = game_state->getMostProbableGhostsPoses();
+    std::vector< geometry_msgs::Pose > ghosts_poses = step_context.getGhostsPoses();
     std::vector< geometry_msgs::Pose >::reverse_iterator closest_ghost;
     bool found_ghost = false;
     for(std::vector< geometry_msgs::Pose >::reverse_iterator it = ghosts_poses.rbegin(); it != ghosts_poses.rend(); ++it) {
         /* std::cout << *it; ... */
-        int distance = distances[std::make_pair(it->position.x, it->position.y)];
+        int distance = distance_matrix.distance(distances, it->position.x, it->position.y);
         if(distance != 0 && distance < min_distance)
         {
             closest_ghost = it;
@@ -70,14 +72,14 @@ pacman_msgs::PacmanAction BayesianBehaviorAgent::getHuntAction(BayesianGameState
     if(!found_ghost)
         closest_ghost = ghosts_poses.rbegin();
 
-    distances = game_state->getDistances(closest_ghost->position.x, closest_ghost->position.y);
+    distances = distance_matrix.getDistanceRow(closest_ghost->position.x, closest_ghost->position.y);
     std::vector< pacman_msgs::PacmanAction > actions = game_state->getLegalActions(pacman_pose.position.x, pacman_pose.position.y);
     std::vector< std::pair<int, int> > next_positions = game_state->getLegalNextPositions(pacman_pose.position.x, pacman_pose.position.y);
 
     int action_iterator = 0;
     for(int i = next_positions.size() - 1; i != -1; i--)
     {
-        if ( distances[ next_positions[i] ] < min_distance )
+        if ( distance_matrix.distance(distances, next_positions[i].first, next_positions[i].second) < min_distance )
         {
             action_iterator = i;
             break;
@@ -90,17 +92,19 @@ pacman_msgs::PacmanAction BayesianBehaviorAgent::getHuntAction(BayesianGameState
 pacman_msgs::PacmanAction BayesianBehaviorAgent::getRunAction(BayesianGameState *game_state) {
     pacman_msgs::PacmanAction action;
 
-    geometry_msgs::Pose pacman_pose = game_state->getMostProbablePacmanPose();
-    std::map< std::pair<int, int>, int > distances = game_state->getDistances(pacman_pose.position.x, pacman_pose.position.y);
+    StepContext<BayesianGameState>& step_context = game_state->getStepContext();
+    const geometry_msgs::Pose& pacman_pose = step_context.getPacmanPose();
+    const DistanceMatrix& distance_matrix = game_state->getDistanceMatrix();
+    const uint16_t *distances = step_context.getPacmanDistances();
 
     int min_distance = util::MAX_DISTANCE;
 
-    std::vector< geometry_msgs::Pose > ghosts_poses = game_state->getMostProbableGhostsPoses();
+    std::vector< geometry_msgs::Pose > ghosts_poses = step_context.getGhostsPoses();
     std::vector< geometry_msgs::Pose >::reverse_iterator closest_ghost;
     bool found_ghost = false;
     for(std::vector< geometry_msgs::Pose >::reverse_iterator it = ghosts_poses.rbegin(); it != ghosts_poses.rend(); ++it) {
         /* std::cout << *it; ... */
-        int distance = distances[std::make_pair(it->position.x, it->position.y)];
+        int distance = distance_matrix.distance(distances, it->position.x, it->position.y);
         if(distance != 0 && distance < min_distance)
         {
             closest_ghost = it;
@@ -112,14 +116,14 @@ pacman_msgs::PacmanAction BayesianBehaviorAgent::getRunAction(BayesianGameState
     if(!found_ghost)
         closest_ghost = ghosts_poses.rbegin();
 
-    distances = game_state->getDistances(closest_ghost->position.x, closest_ghost->position.y);
+    distances = distance_matrix.getDistanceRow(closest_ghost->position.x, closest_ghost->position.y);
     std::vector< pacman_msgs::PacmanAction > actions = game_state->getLegalActions(pacman_pose.position.x, pacman_pose.position.y);
     std::vector< std::pair<int, int> > next_positions = game_state->getLegalNextPositions(pacman_pose.position.x, pacman_pose.position.y);
 
     int action_iterator = 0;
     for(int i = next_positions.size() - 1; i != -1; i--)
     {
-        if ( distances[ next_positions[i] ] > min_distance )
+        if ( distance_matrix.distance(distances, next_positions[i].first, next_positions[i].second) > min_distance )
         {
             action_iterator = i;
             break;
@@ -130,42 +134,24 @@ pacman_msgs::PacmanAction BayesianBehaviorAgent::getRunAction(BayesianGameState
 }
 
 pacman_msgs::PacmanAction BayesianBehaviorAgent::getEatBigFoodAction(BayesianGameState *game_state) {
-    geometry_msgs::Pose pacman_pose = game_state->getMostProbablePacmanPose();
-    std::map< std::pair<int, int>, int > distances = game_state->getDistances(pacman_pose.position.x, pacman_pose.position.y);
-    std::vector< std::vector<float> > big_foods_map = game_state->getBigFoodMap();
-    float food_probability_threshold = game_state->getMaxBigFoodProbability()/2.0;
+    StepContext<BayesianGameState>& step_context = game_state->getStepContext();
+    const geometry_msgs::Pose& pacman_pose = step_context.getPacmanPose();
+    const DistanceMatrix& distance_matrix = game_state->getDistanceMatrix();
 
+    int min_distance;
+    int food_cell = game_state->findClosestBigFoodCell(util::MAX_DISTANCE, min_distance);
     int width = game_state->getWidth();
-    int height = game_state->getHeight();
+    int food_x = (food_cell < 0) ? -1 : food_cell % width;
+    int food_y = (food_cell < 0) ? -1 : food_cell / width;
 
-    int min_distance = util::MAX_DISTANCE;
-    int food_x = -1;
-    int food_y = -1;
-    for (int i = 0 ; i < width ; i++)
-    {
-        for (int j = 0 ; j < height ; j++)
-        {
-            if( big_foods_map[j][i] >= food_probability_threshold)
-            {
-                int distance = distances[std::make_pair(i, j)];
-                if(distance < min_distance)
-                {
-                    food_x = i;
-                    food_y = j;
-                    min_distance = distance;
-                }
-            }
-        }
-    }
-
-    distances = game_state->getDistances(food_x, food_y);
+    const uint16_t *distances = distance_matrix.getDistanceRow(food_x, food_y);
     std::vector< pacman_msgs::PacmanAction > actions = game_state->getLegalActions(pacman_pose.position.x, pacman_pose.position.y);
     std::vector< std::pair<int, int> > next_positions = game_state->getLegalNextPositions(pacman_pose.position.x, pacman_pose.position.y);
 
     int action_iterator = 0;
     for(int i = next_positions.size() - 1; i != -1; i--)
     {
-        if ( distances[ next_positions[i] ] < min_distance )
+        if ( distance_matrix.distance(distances, next_positions[i].first, next_positions[i].second) < min_distance )
         {
             action_iterator = i;
             break;
@@ -178,42 +164,24 @@ pacman_msgs::PacmanAction BayesianBehaviorAgent::getEatBigFoodAction(BayesianGam
 pacman_msgs::PacmanAction BayesianBehaviorAgent::getEatAction(BayesianGameState *game_state) {
     pacman_msgs::PacmanAction action;
 
-    geometry_msgs::Pose pacman_pose = game_state->getMostProbablePacmanPose();
-    std::map< std::pair<int, int>, int > distances = game_state->getDistances(pacman_pose.position.x, pacman_pose.position.y);
-    std::vector< std::vector<float> > foods_map = game_state->getFoodMap();
-    float food_probability_threshold = game_state->getMaxFoodProbability()/2.0;
+    StepContext<BayesianGameState>& step_context = game_state->getStepContext();
+    const geometry_msgs::Pose& pacman_pose = step_context.getPacmanPose();
+    const DistanceMatrix& distance_matrix = game_state->getDistanceMatrix();
 
+    int min_distance;
+    int food_cell = game_state->findClosestFoodCell(util::MAX_DISTANCE, min_distance);
     int width = game_state->getWidth();
-    int height = game_state->getHeight();
-
-    int min_distance = util::MAX_DISTANCE;
-    int food_x = -1;
-    int food_y = -1;
-    for (int i = 0 ; i < width ; i++)
-    {
-        for (int j = 0 ; j < height ; j++)
-        {
-            if( foods_map[j][i] >= food_probability_threshold)
-            {
-                int distance = distances[std::make_pair(i, j)];
-                if(distance < min_distance)
-                {
-                    food_x = i;
-                    food_y = j;
-                    min_distance = distance;
-                }
-            }
-        }
-    }
+    int food_x = (food_cell < 0) ? -1 : food_cell % width;
+    int food_y = (food_cell < 0) ? -1 : food_cell / width;
 
-    distances = game_state->getDistances(food_x, food_y);
+    const uint16_t *distances = distance_matrix.getDistanceRow(food_x, food_y);
     std::vector< pacman_msgs::PacmanAction > actions = game_state->getLegalActions(pacman_pose.position.x, pacman_pose.position.y);
     std::vector< std::pair<int, int> > next_positions = game_state->getLegalNextPositions(pacman_pose.position.x, pacman_pose.position.y);
 
     int action_iterator = 0;
     for(int i = next_positions.size() - 1; i != -1; i--)
     {
-        if ( distances[ next_positions[i] ] < min_distance )
+        if ( distance_matrix.distance(distances, next_positions[i].first, next_positions[i].second) < min_distance )
         {
             action_iterator = i;
             break;
@@ -1,16 +1,60 @@
 #include "bayesian_q_5_behaviors/bayesian_game_state_5_behaviors.h"
 
 #include "pacman_abstract_classes/util_functions.h"
+#include "pacman_abstract_classes/likelihood_table.h"
 #include <boost/math/special_functions/round.hpp>
+#include <algorithm>
 
 
-BayesianGameState::BayesianGameState()
+BayesianGameState::BayesianGameState(BeliefStorage belief_storage)
 {
     pacman_observer_service_ = n_.advertiseService<pacman_msgs::AgentPoseService::Request, pacman_msgs::AgentPoseService::Response>
                                 ("/pacman/pacman_pose/error", boost::bind(&BayesianGameState::observeAgent, this, _1, _2));
     ghost_distance_observer_service_ = n_.advertiseService<pacman_msgs::AgentPoseService::Request, pacman_msgs::AgentPoseService::Response>
                                 ("/pacman/ghost_distance/error", boost::bind(&BayesianGameState::observeAgent, this, _1, _2));
 
+    agents_storage_ = (belief_storage == QUANTIZED_BELIEFS) ? ProbabilityGrid::BFLOAT16 : ProbabilityGrid::FLOAT;
+    foods_storage_ = (belief_storage == QUANTIZED_BELIEFS) ? ProbabilityGrid::FIXED_POINT : ProbabilityGrid::FLOAT;
+    convertBeliefs();
+
+    next_pose_map_ = ProbabilityGrid(width_, height_);
+    next_pose_map_.setOpenCellsMask(open_cells_mask_);
+    next_support_ = BeliefSupport(width_, height_);
+
+    pacman_support_ = BeliefSupport(width_, height_);
+    pacman_support_.rebuild(pacman_pose_map_);
+    for (int ghost_index = 0 ; ghost_index < num_ghosts_ ; ghost_index++)
+    {
+        ghosts_supports_.push_back(BeliefSupport(width_, height_));
+        ghosts_supports_[ghost_index].rebuild(ghosts_poses_map_[ghost_index]);
+    }
+
+    // ghosts are observed in parallel, so each one has its own observation engine
+    ghost_distance_observation_engines_ = std::vector< ObservationEngine > (num_ghosts_, ObservationEngine(0.01));
+    for (int ghost_index = 0 ; ghost_index < num_ghosts_ ; ghost_index++)
+        ghost_distance_observation_engines_[ghost_index].setTaskScheduler(&task_scheduler_);
+
+    // a band starting at a ghost holds at most the ghosts from it to the last one
+    stacked_ghosts_beliefs_ = std::vector< StackedGhostsBeliefs > (num_ghosts_);
+    for (int ghost_index = 0 ; ghost_index < num_ghosts_ ; ghost_index++)
+    {
+        StackedGhostsBeliefs& stacked_beliefs = stacked_ghosts_beliefs_[ghost_index];
+        stacked_beliefs.beliefs = std::vector<float> (width_ * height_ * (num_ghosts_ - ghost_index), 0);
+        stacked_beliefs.next_beliefs = std::vector<float> (width_ * height_ * (num_ghosts_ - ghost_index), 0);
+        stacked_beliefs.support = BeliefSupport(width_, height_);
+        stacked_beliefs.next_support = BeliefSupport(width_, height_);
+    }
+
+    pruning_threshold_ = 0;
+    pruned_masses_ = std::vector<double> (num_ghosts_ + 1, 0.0);
+
+    food_belief_.rebuild(foods_map_);
+    big_food_belief_.rebuild(big_foods_map_);
+
+    is_ghost_most_probable_cell_valid_ = std::vector<char> (num_ghosts_, false);
+    ghosts_most_probable_cells_ = std::vector<int> (num_ghosts_, -1);
+    invalidateSummaries();
+
     precalculateAllDistances();
     //ROS_DEBUG_STREAM("Bayesian game state initialized");
 }
@@ -20,58 +64,205 @@ BayesianGameState::~BayesianGameState()
     pacman_observer_service_.shutdown();
     ghost_distance_observer_service_.shutdown();
 
-    precalculated_distances_.clear();
 
     //ROS_INFO_STREAM("Bayesian game state destroyed");
 }
 
+void BayesianGameState::reset()
+{
+    GameState::reset();
+    is_finished_ = false;
+
+    rebuildSupports();
+    invalidateSummaries();
+    std::fill(pruned_masses_.begin(), pruned_masses_.end(), 0.0);
+}
+
+void BayesianGameState::convertBeliefs()
+{
+    // reset copies the initial beliefs, so they are kept in the same storage
+    pacman_pose_map_.setStorage(agents_storage_);
+    initial_pacman_pose_map_.setStorage(agents_storage_);
+    for (int ghost_index = 0 ; ghost_index < num_ghosts_ ; ghost_index++)
+    {
+        ghosts_poses_map_[ghost_index].setStorage(agents_storage_);
+        initial_ghosts_poses_map_[ghost_index].setStorage(agents_storage_);
+    }
+
+    foods_map_.setStorage(foods_storage_);
+    initial_foods_map_.setStorage(foods_storage_);
+    big_foods_map_.setStorage(foods_storage_);
+    initial_big_foods_map_.setStorage(foods_storage_);
+}
+
+void BayesianGameState::setPruningThreshold(float pruning_threshold)
+{
+    pruning_threshold_ = pruning_threshold;
+}
+
+float BayesianGameState::getPruningThreshold()
+{
+    return pruning_threshold_;
+}
+
+double BayesianGameState::getPrunedMass()
+{
+    double pruned_mass = 0;
+    for(std::vector<double>::reverse_iterator it = pruned_masses_.rbegin(); it != pruned_masses_.rend(); ++it)
+        pruned_mass += *it;
+
+    return pruned_mass;
+}
+
+void BayesianGameState::setPacmanPoseMap(const ProbabilityGrid& pacman_pose_map)
+{
+    GameState::setPacmanPoseMap(pacman_pose_map);
+    pacman_pose_map_.setStorage(agents_storage_);
+
+    pacman_support_.rebuild(pacman_pose_map_);
+    is_pacman_most_probable_cell_valid_ = false;
+}
+
+void BayesianGameState::setGhostPoseMap(const ProbabilityGrid& ghost_pose_map, int ghost_index)
+{
+    GameState::setGhostPoseMap(ghost_pose_map, ghost_index);
+    ghosts_poses_map_[ghost_index].setStorage(agents_storage_);
+
+    ghosts_supports_[ghost_index].rebuild(ghosts_poses_map_[ghost_index]);
+    is_ghost_most_probable_cell_valid_[ghost_index] = false;
+}
+
+void BayesianGameState::setFoodMap(const ProbabilityGrid& foods_map)
+{
+    GameState::setFoodMap(foods_map);
+    foods_map_.setStorage(foods_storage_);
+
+    food_belief_.rebuild(foods_map_);
+    is_max_food_probability_valid_ = false;
+}
+
+void BayesianGameState::setBigFoodMap(const ProbabilityGrid& big_foods_map)
+{
+    GameState::setBigFoodMap(big_foods_map);
+    big_foods_map_.setStorage(foods_storage_);
+
+    big_food_belief_.rebuild(big_foods_map_);
+    is_max_big_food_probability_valid_ = false;
+}
+
+void BayesianGameState::rebuildSupports()
+{
+    // next_pose_map_ is zeroed after every swap, only the supports follow the restored beliefs
+    next_support_.clear();
+    pacman_support_.rebuild(pacman_pose_map_);
+    for (int ghost_index = 0 ; ghost_index < num_ghosts_ ; ghost_index++)
+        ghosts_supports_[ghost_index].rebuild(ghosts_poses_map_[ghost_index]);
+
+    food_belief_.rebuild(foods_map_);
+    big_food_belief_.rebuild(big_foods_map_);
+}
+
+void BayesianGameState::invalidateSummaries()
+{
+    is_pacman_most_probable_cell_valid_ = false;
+    std::fill(is_ghost_most_probable_cell_valid_.begin(), is_ghost_most_probable_cell_valid_.end(), false);
+    is_max_food_probability_valid_ = false;
+    is_max_big_food_probability_valid_ = false;
+}
+
 void BayesianGameState::observePacman(double measurement_x, double measurement_y)
+{
+    state_version_++;
+
+    applyPacmanObservation(measurement_x, measurement_y);
+
+    //ROS_WARN_STREAM("PAcman pose: x " << measurement_x << " y " << measurement_y);
+    //printPacmanOrGhostPose(true, 0);
+    //printDeterministicMap();
+}
+
+void BayesianGameState::observeGhost(double measurement_x_dist, double measurement_y_dist, int ghost_index)
+{
+    state_version_++;
+
+    gatherPacmanSupport();
+    applyGhostObservation(measurement_x_dist, measurement_y_dist, ghost_index);
+}
+
+void BayesianGameState::observeAgents(double pacman_measurement_x, double pacman_measurement_y,
+                                const std::vector< std::pair<double, double> >& ghosts_measurements)
+{
+    state_version_++;
+
+    int pacman_task = task_scheduler_.addTask(boost::bind(&BayesianGameState::applyPacmanObservation, this,
+                                pacman_measurement_x, pacman_measurement_y));
+    // every ghost likelihood is relative to the same (now observed) pacman belief
+    int gather_task = task_scheduler_.addTask(boost::bind(&BayesianGameState::gatherPacmanSupport, this), pacman_task);
+
+    for (int ghost_index = 0 ; ghost_index < (int) ghosts_measurements.size() && ghost_index < num_ghosts_ ; ghost_index++)
+        task_scheduler_.addTask(boost::bind(&BayesianGameState::applyGhostObservation, this, ghosts_measurements[ghost_index].first,
+                                ghosts_measurements[ghost_index].second, ghost_index), gather_task);
+
+    task_scheduler_.run();
+
+    ROS_DEBUG_STREAM_COND(getPrunedMass() > 0, "Pruned belief mass in this tick: " << getPrunedMass());
+}
+
+void BayesianGameState::applyPacmanObservation(double measurement_x, double measurement_y)
 {
     float SD_PACMAN_MEASUREMENT = 0.01;
 
-    std::vector<float> pacman_pose_map_line (width_, 0);
-    std::vector< std::vector<float> > pacman_new_pose_map (height_, pacman_pose_map_line);
+    int measurement_x_int = boost::math::iround(measurement_x);
+    int measurement_y_int = boost::math::iround(measurement_y);
+
     float sum_probabilities = 0.0;
 
-    for (int i = 0 ; i < width_ ; i++)
+    if (LikelihoodTable::isNearlyDeterministic(SD_PACMAN_MEASUREMENT))
     {
-        for (int j = 0 ; j < height_ ; j++)
-        {
-            if( map_[j][i] != WALL)
-            {
-                float old_probability_of_being_in_this_place = pacman_pose_map_[j][i];
-                float probability_of_place_given_z = util::getProbOfMeasurementGivenPosition(i, j, measurement_x, measurement_y, SD_PACMAN_MEASUREMENT);
-
-                //ROS_INFO_STREAM("" << random_probability);
-                pacman_new_pose_map[j][i] = probability_of_place_given_z * old_probability_of_being_in_this_place;
+        // only the measured cell keeps a likelihood, which cancels out on normalization
+        int measured_cell = -1;
+        if (measurement_x_int >= 0 && measurement_x_int < width_ && measurement_y_int >= 0 && measurement_y_int < height_)
+            measured_cell = measurement_y_int * width_ + measurement_x_int;
 
-                sum_probabilities += pacman_new_pose_map[j][i];
-            }
+        for (int k = 0 ; k < pacman_support_.size() ; k++)
+        {
+            int cell = pacman_support_.getCell(k);
+            if (cell == measured_cell)
+                sum_probabilities = pacman_pose_map_.get(cell);
+            else
+                pacman_pose_map_.set(cell, 0);
         }
     }
-
-    for (int i = 0 ; i < width_ ; i++)
+    else
     {
-        for (int j = 0 ; j < height_ ; j++)
+        // the gaussian is separable, so each cell likelihood is the product of its column and row weights
+        const LikelihoodTable& likelihood_table = LikelihoodTable::getTable(SD_PACMAN_MEASUREMENT, std::max(width_, height_));
+        likelihood_table.getAxisWeights(measurement_x, width_, pacman_measurement_x_weights_);
+        likelihood_table.getAxisWeights(measurement_y, height_, pacman_measurement_y_weights_);
+
+        // cells outside the support have probability 0 and stay that way
+        for (int k = 0 ; k < pacman_support_.size() ; k++)
         {
-            if( map_[j][i] != WALL)
-            {
-                if(sum_probabilities != 0)
-                    pacman_new_pose_map[j][i] = pacman_new_pose_map[j][i]/sum_probabilities;
-                else
-                {
-                    ROS_WARN_STREAM_THROTTLE(1, "Probability 0 for pacman, redistributing");
-                    pacman_new_pose_map[j][i] = 1.0 / (float) ( height_ * width_ );
-                }
-            }
+            int cell = pacman_support_.getCell(k);
+            int i = pacman_support_.getX(k);
+            int j = pacman_support_.getY(k);
+
+            float old_probability_of_being_in_this_place = pacman_pose_map_.get(cell);
+            float probability_of_place_given_z = pacman_measurement_x_weights_[i] * pacman_measurement_y_weights_[j];
+
+            pacman_pose_map_.set(cell, probability_of_place_given_z * old_probability_of_being_in_this_place);
+
+            sum_probabilities += pacman_pose_map_.get(cell);
         }
     }
 
-    pacman_pose_map_.clear();
-    pacman_pose_map_ = pacman_new_pose_map;
-
-    int measurement_x_int = boost::math::iround(measurement_x);
-    int measurement_y_int = boost::math::iround(measurement_y);
+    is_pacman_most_probable_cell_valid_ = normalizeBelief(pacman_pose_map_, pacman_support_, sum_probabilities,
+                                pacman_most_probable_cell_, pruned_masses_[0]);
+    if (!is_pacman_most_probable_cell_valid_)
+    {
+        ROS_WARN_STREAM_THROTTLE(1, "Probability 0 for pacman, redistributing");
+        redistributeProbability(pacman_pose_map_, pacman_support_);
+    }
 
     if( measurement_x_int > 0 && measurement_x_int < width_ && 
         measurement_y_int > 0 && measurement_y_int < height_ && 
@@ -79,78 +270,165 @@ void BayesianGameState::observePacman(double measurement_x, double measurement_y
     {
         map_[measurement_y_int][measurement_x_int] = EMPTY;
     }
-
-    //ROS_WARN_STREAM("PAcman pose: x " << measurement_x << " y " << measurement_y);
-    //printPacmanOrGhostPose(true, 0);
-    //printDeterministicMap();
 }
 
-void BayesianGameState::observeGhost(double measurement_x_dist, double measurement_y_dist, int ghost_index)
+void BayesianGameState::gatherPacmanSupport()
 {
-    double SD_GHOST_DIST_MEASUREMENT = 0.01;
+    int support_size = pacman_support_.size();
+    pacman_support_xs_.resize(support_size);
+    pacman_support_ys_.resize(support_size);
+    pacman_support_probabilities_.resize(support_size);
 
-    std::vector< std::vector<float> > ghost_pose_map = ghosts_poses_map_[ghost_index];
+    for (int k = 0 ; k < support_size ; k++)
+    {
+        int cell = pacman_support_.getCell(k);
+        pacman_support_xs_[k] = cell % width_;
+        pacman_support_ys_[k] = cell / width_;
+        pacman_support_probabilities_[k] = pacman_pose_map_.get(cell);
+    }
+}
 
-    std::vector<float> ghost_pose_map_line (width_, 0);
-    std::vector< std::vector<float> > ghost_new_pose_map (height_, ghost_pose_map_line);
+void BayesianGameState::applyGhostObservation(double measurement_x_dist, double measurement_y_dist, int ghost_index)
+{
+    ProbabilityGrid& ghost_pose_map = ghosts_poses_map_[ghost_index];
+    BeliefSupport& ghost_support = ghosts_supports_[ghost_index];
+    ObservationEngine& ghost_distance_observation_engine = ghost_distance_observation_engines_[ghost_index];
     float sum_probabilities = 0.0;
 
-    for (int i = 0 ; i < width_ ; i++)
+    int pacman_support_size = pacman_support_xs_.size();
+    if (ghost_distance_observation_engine.isNearlyDeterministic())
     {
-        for (int j = 0 ; j < height_ ; j++)
+        // only the measured offset keeps a likelihood, so a ghost cell is as likely as pacman being that far from it
+        int measurement_x_dist_int = boost::math::iround(measurement_x_dist);
+        int measurement_y_dist_int = boost::math::iround(measurement_y_dist);
+
+        for (int k = 0 ; k < ghost_support.size() ; k++)
         {
-            if( map_[j][i] != WALL)
+            int cell = ghost_support.getCell(k);
+            int i = ghost_support.getX(k);
+            int j = ghost_support.getY(k);
+            int pacman_x = i - measurement_x_dist_int;
+            int pacman_y = j - measurement_y_dist_int;
+
+            double probability_of_z = 0.0;
+            if (pacman_x >= 0 && pacman_x < width_ && pacman_y >= 0 && pacman_y < height_)
+                probability_of_z = pacman_pose_map_.get(pacman_y * width_ + pacman_x);
+
+            ghost_pose_map.set(cell, probability_of_z * ghost_pose_map.get(cell));
+            sum_probabilities += ghost_pose_map.get(cell);
+        }
+    }
+    else if (pacman_support_size * ghost_support.size() < width_ * height_)
+    {
+        // both beliefs are concentrated, so pair their supports directly
+        ghost_distance_observation_engine.setMeasurement(measurement_x_dist, measurement_y_dist, width_, height_);
+
+        for (int k = 0 ; k < ghost_support.size() ; k++)
+        {
+            int cell = ghost_support.getCell(k);
+            int i = ghost_support.getX(k);
+            int j = ghost_support.getY(k);
+
+            double probability_of_z = 0.0;
+            for (int pacman_k = 0 ; pacman_k < pacman_support_size ; pacman_k++)
             {
-                float old_probability_of_being_in_this_place = ghost_pose_map[j][i];
-                for (int pacman_i = 0 ; pacman_i < width_ ; pacman_i++)
-                {
-                    for (int pacman_j = 0 ; pacman_j < height_ ; pacman_j++)
-                    {
-                        float probability_of_pacman = pacman_pose_map_[pacman_j][pacman_i];
-                        float probability_of_place_given_z = util::getProbOfMeasurementGivenPosition(i - pacman_i, j - pacman_j, measurement_x_dist, measurement_y_dist, SD_GHOST_DIST_MEASUREMENT);
-
-                        //ROS_INFO_STREAM("" << random_probability);
-                        ghost_new_pose_map[j][i] += probability_of_place_given_z * old_probability_of_being_in_this_place * probability_of_pacman;
-                    }
-                }
-                sum_probabilities += ghost_new_pose_map[j][i];
+                probability_of_z += pacman_support_probabilities_[pacman_k] *
+                            ghost_distance_observation_engine.getOffsetLikelihood(i - pacman_support_xs_[pacman_k], j - pacman_support_ys_[pacman_k]);
             }
+
+            ghost_pose_map.set(cell, probability_of_z * ghost_pose_map.get(cell));
+            sum_probabilities += ghost_pose_map.get(cell);
         }
     }
-
-    if(sum_probabilities == 0)
+    else
     {
-        /*ROS_INFO_STREAM("measurement_x_dist " << measurement_x_dist << " y_dist " << measurement_y_dist);
-        std::vector<float> ghost_white_prob (num_ghosts_, 0.0);
-        for(std::vector< std::vector<float> >::reverse_iterator it = probability_ghosts_white_.rbegin(); it != probability_ghosts_white_.rend(); ++it)
+        ProbabilityGrid likelihood_map = ghost_distance_observation_engine.getRelativeMeasurementLikelihood(
+                                    pacman_pose_map_, measurement_x_dist, measurement_y_dist);
+
+        const float *likelihoods = likelihood_map.data();
+
+        for (int k = 0 ; k < ghost_support.size() ; k++)
         {
-            ghost_white_prob[ghost_index] += (*it)[ghost_index];
-        }
+            int cell = ghost_support.getCell(k);
 
-        // TODO: check this
-        ROS_INFO_STREAM("white prob " << ghost_white_prob[ghost_index]/2.0);
-        printPacmanOrGhostPose(false, ghost_index);
-        printPacmanOrGhostPose(true, ghost_index);*/
+            ghost_pose_map.set(cell, likelihoods[cell] * ghost_pose_map.get(cell));
+            sum_probabilities += ghost_pose_map.get(cell);
+        }
+    }
 
+    is_ghost_most_probable_cell_valid_[ghost_index] = normalizeBelief(ghost_pose_map, ghost_support, sum_probabilities,
+                                ghosts_most_probable_cells_[ghost_index], pruned_masses_[ghost_index + 1]);
+    if (!is_ghost_most_probable_cell_valid_[ghost_index])
+    {
         ROS_WARN_STREAM("Probability 0 for ghost " << ghost_index << ", redistributing");
+        redistributeProbability(ghost_pose_map, ghost_support);
     }
+}
+
+bool BayesianGameState::normalizeBelief(ProbabilityGrid& pose_map, BeliefSupport& support, float sum_probabilities,
+                                int& most_probable_cell, double& pruned_mass)
+{
+    if (sum_probabilities == 0)
+        return false;
 
-    for (int i = 0 ; i < width_ ; i++)
+    // pruning keeps the total, so the kept cells are normalized by it as well
+    pruned_mass += support.prune(pose_map, pruning_threshold_);
+
+    // the most probable cell is found while normalizing, ties go to the lowest x and then the lowest y
+    float max_probability = -1;
+    most_probable_cell = -1;
+
+    for (int k = 0 ; k < support.size() ; k++)
     {
-        for (int j = 0 ; j < height_ ; j++)
+        int cell = support.getCell(k);
+        pose_map.set(cell, pose_map.get(cell)/sum_probabilities);
+
+        float probability = pose_map.get(cell);
+        if (probability > max_probability || ( probability == max_probability && isSweptBefore(cell, most_probable_cell) ) )
         {
-            if( map_[j][i] != WALL)
-            {
-                if(sum_probabilities != 0)
-                    ghost_new_pose_map[j][i] = ghost_new_pose_map[j][i]/sum_probabilities;
-                else
-                    ghost_new_pose_map[j][i] = 1.0 / (float) ( height_ * width_ );
-            }
+            most_probable_cell = cell;
+            max_probability = probability;
         }
     }
+    support.removeEmptyCells(pose_map);
 
-    ghosts_poses_map_[ghost_index].clear();
-    ghosts_poses_map_[ghost_index] = ghost_new_pose_map;
+    return true;
+}
+
+void BayesianGameState::redistributeProbability(ProbabilityGrid& pose_map, BeliefSupport& support)
+{
+    pose_map.fillOpenCells(1.0 / (float) ( height_ * width_ ));
+    support.rebuild(pose_map);
+}
+
+void BayesianGameState::swapWithNextPoseMap(ProbabilityGrid& pose_map, BeliefSupport& support,
+                                ProbabilityGrid& next_pose_map, BeliefSupport& next_support)
+{
+    if (pose_map.getStorage() == next_pose_map.getStorage())
+    {
+        pose_map.swap(next_pose_map);
+
+        // next_pose_map now holds the old belief, which is only non zero inside the old support
+        float *old_probabilities = next_pose_map.data();
+        for (int k = 0 ; k < support.size() ; k++)
+            old_probabilities[support.getCell(k)] = 0;
+    }
+    else
+    {
+        // a 16 bit belief takes the float prediction cell by cell
+        float *next_probabilities = next_pose_map.data();
+        for (int k = 0 ; k < support.size() ; k++)
+            pose_map.set(support.getCell(k), 0);
+        for (int k = 0 ; k < next_support.size() ; k++)
+        {
+            int cell = next_support.getCell(k);
+            pose_map.set(cell, next_probabilities[cell]);
+            next_probabilities[cell] = 0;
+        }
+    }
+
+    support.swap(next_support);
+    next_support.clear();
 }
 
 bool BayesianGameState::observeAgent(pacman_msgs::AgentPoseService::Request &req, pacman_msgs::AgentPoseService::Response &res)
@@ -184,87 +462,87 @@ bool BayesianGameState::observeAgent(pacman_msgs::AgentPoseService::Request &req
 
 void BayesianGameState::predictPacmanMove(pacman_msgs::PacmanAction action)
 {
-    //ROS_INFO_STREAM("Predict pacman");
+    state_version_++;
+    std::fill(pruned_masses_.begin(), pruned_masses_.end(), 0.0);
 
-    std::vector<float> map_line (width_, 0);
-    std::vector< std::vector<float> > pacman_new_pose_map (height_, map_line);
-    std::vector< std::vector<float> > new_foods_map (height_, map_line);
-    std::vector< std::vector<float> > new_big_foods_map (height_, map_line);
-    map_line.clear();
+    predictPacmanBelief(action);
+}
 
+void BayesianGameState::predictPacmanBelief(pacman_msgs::PacmanAction action)
+{
+    //ROS_INFO_STREAM("Predict pacman");
+
+    ProbabilityGrid& pacman_new_pose_map = next_pose_map_;
     std::vector<double> total_chance_pacman_or_ghost_killed (num_ghosts_, 0.0);
 
-    for (int i = 0 ; i < width_ ; i++)
+    float *pacman_new_probabilities = pacman_new_pose_map.data();
+
+    for (int k = 0 ; k < pacman_support_.size() ; k++)
     {
-        for (int j = 0 ; j < height_ ; j++)
+        int cell = pacman_support_.getCell(k);
+        float probability_of_being_in_this_place = pacman_pose_map_.get(cell);
+
+        int row_end = transition_matrix_.getRowEnd(cell);
+        for (int entry = transition_matrix_.getRowBegin(cell) ; entry < row_end ; entry++)
         {
-            if( map_[j][i] != WALL)
+            float probability_of_move = transition_matrix_.getActionProbability(action.action, entry);
+            // moves the action never takes add no mass, so they do not get a kill either,
+            // which keeps the kills independent of which empty cells the support still holds
+            if (probability_of_move == 0)
+                continue;
+
+            int next_cell = transition_matrix_.getTarget(entry);
+            pacman_new_probabilities[next_cell] += probability_of_move * probability_of_being_in_this_place;
+            next_support_.addCell(next_cell);
+
+            // it can be done like this, without checking if ghost is white, 
+            // because if pacman survives, it doesnt matter if moved the ghost
+            for(int ghost_index = 0; ghost_index < num_ghosts_ ; ++ghost_index)
             {
-                float probability_of_being_in_this_place = pacman_pose_map_[j][i];
-
-                std::vector< std::pair< float, std::pair<int, int> > > next_positions = getNextPositionsForActionWithProbabilities(i, j, action);
-
-                //ROS_INFO_STREAM("" << random_probability);
-
-                for(std::vector< std::pair< float, std::pair<int, int> > >::reverse_iterator it = next_positions.rbegin(); it != next_positions.rend(); ++it)
-                {
-                    /* std::cout << *it; ... */
-                    float probability_of_move = it->first;
-                    int x = it->second.first;
-                    int y = it->second.second;
-                    pacman_new_pose_map[y][x] += probability_of_move * probability_of_being_in_this_place;
-
-                    // it can be done like this, without checking if ghost is white, 
-                    // because if pacman survives, it doesnt matter if moved the ghost
-                    for(int ghost_index = 0; ghost_index < num_ghosts_ ; ++ghost_index)
-                    {
-                        geometry_msgs::Pose ghost_spawn = ghosts_spawn_poses_[ghost_index];
-                        double chance_pacman_or_ghost_killed = pacman_new_pose_map[y][x] * ghosts_poses_map_[ghost_index][y][x];
-
-                        ghosts_poses_map_[ghost_index][y][x] -= chance_pacman_or_ghost_killed;
-                        ghosts_poses_map_[ghost_index][ghost_spawn.position.y][ghost_spawn.position.x] += \
-                                        chance_pacman_or_ghost_killed;
-
-                        total_chance_pacman_or_ghost_killed[ghost_index] += chance_pacman_or_ghost_killed;
-                    }
-                }
-            }
-        }
-    }
+                ProbabilityGrid& ghost_pose_map = ghosts_poses_map_[ghost_index];
+                float ghost_probability = ghost_pose_map.get(next_cell);
+                double chance_pacman_or_ghost_killed = pacman_new_probabilities[next_cell] * ghost_probability;
 
-    for(std::vector< std::vector<float> >::reverse_iterator it = probability_ghosts_white_.rbegin(); it != probability_ghosts_white_.rend(); ++it)
-    {
-        for(int ghost_index = 0; ghost_index < num_ghosts_ ; ++ghost_index)
-            (*it)[ghost_index] *= (1 - total_chance_pacman_or_ghost_killed[ghost_index]);
-    }
+                if (chance_pacman_or_ghost_killed == 0)
+                    continue;
 
-    double chance_eaten_big_foood = 0.0;
+                geometry_msgs::Pose ghost_spawn = ghosts_spawn_poses_[ghost_index];
+                int spawn_cell = (int) ghost_spawn.position.y * width_ + (int) ghost_spawn.position.x;
 
-    for (int i = 0 ; i < width_ ; i++)
-    {
-        for (int j = 0 ; j < height_ ; j++)
-        {
-            if( map_[j][i] != WALL)
-            {
-                new_foods_map[j][i] = foods_map_[j][i] * ( 1 - pacman_new_pose_map[j][i]);
-                new_big_foods_map[j][i] = big_foods_map_[j][i] * ( 1 - pacman_new_pose_map[j][i]);
+                ghost_pose_map.set(next_cell, ghost_probability - chance_pacman_or_ghost_killed);
+                ghost_pose_map.set(spawn_cell, ghost_pose_map.get(spawn_cell) + chance_pacman_or_ghost_killed);
+                ghosts_supports_[ghost_index].addCell(spawn_cell);
 
-                chance_eaten_big_foood += big_foods_map_[j][i] * pacman_new_pose_map[j][i];
+                total_chance_pacman_or_ghost_killed[ghost_index] += chance_pacman_or_ghost_killed;
             }
         }
     }
 
-    pacman_pose_map_.clear();
-    pacman_pose_map_ = pacman_new_pose_map;
+    swapWithNextPoseMap(pacman_pose_map_, pacman_support_, next_pose_map_, next_support_);
+    pruned_masses_[0] += pacman_support_.prune(pacman_pose_map_, pruning_threshold_);
+    // the kill coupling may have moved any ghost, and food is eaten below
+    invalidateSummaries();
 
-    foods_map_.clear();
-    foods_map_ = new_foods_map;
+    for(int ghost_index = 0; ghost_index < num_ghosts_ ; ++ghost_index)
+        white_ghost_timer_.scale(ghost_index, 1 - total_chance_pacman_or_ghost_killed[ghost_index]);
 
-    big_foods_map_.clear();
-    big_foods_map_ = new_big_foods_map;
+    // food can only be eaten where pacman may be
+    double chance_eaten_big_foood = 0.0;
+
+    for (int k = 0 ; k < pacman_support_.size() ; k++)
+    {
+        int cell = pacman_support_.getCell(k);
+        float probability_of_being_in_this_place = pacman_pose_map_.get(cell);
 
-    probability_ghosts_white_.erase( probability_ghosts_white_.begin() );
-    probability_ghosts_white_.push_back( std::vector<float> (num_ghosts_, chance_eaten_big_foood) );
+        chance_eaten_big_foood += big_foods_map_.get(cell) * probability_of_being_in_this_place;
+
+        foods_map_.set(cell, foods_map_.get(cell) * ( 1 - probability_of_being_in_this_place));
+        big_foods_map_.set(cell, big_foods_map_.get(cell) * ( 1 - probability_of_being_in_this_place));
+        food_belief_.set(cell, foods_map_.get(cell));
+        big_food_belief_.set(cell, big_foods_map_.get(cell));
+    }
+
+    white_ghost_timer_.advance(chance_eaten_big_foood);
 
     //printPacmanOrGhostPose(true, 0);
     //ROS_INFO_STREAM("Foods map");
@@ -275,84 +553,148 @@ void BayesianGameState::predictPacmanMove(pacman_msgs::PacmanAction action)
 
 void BayesianGameState::predictGhostMove(int ghost_index)
 {
-    //ROS_INFO_STREAM("Predict ghost " << ghost_index);
+    state_version_++;
 
-    std::vector<float> ghost_white_prob (num_ghosts_, 0.0);
-    for(std::vector< std::vector<float> >::reverse_iterator it = probability_ghosts_white_.rbegin(); it != probability_ghosts_white_.rend(); ++it)
-    {
-        ghost_white_prob[ghost_index] += (*it)[ghost_index];
-    }
+    predictGhostsBeliefs(ghost_index, ghost_index + 1);
+}
 
-    // TODO: check this
-    double STOP_PROBABILITY = ghost_white_prob[ghost_index]/2.0;
+void BayesianGameState::predictGhostsBeliefs(int begin_ghost, int end_ghost)
+{
+    //ROS_INFO_STREAM("Predict ghosts " << begin_ghost << " to " << end_ghost);
+
+    // ghosts only differ in their stop probability, so their beliefs are stacked as a cells x ghosts
+    // matrix, row cell * num_columns, and all of them are moved in a single pass over the transition matrix.
+    // Columns only write their own ghost, so bands only share the pacman belief they read
+    int num_columns = end_ghost - begin_ghost;
+    StackedGhostsBeliefs& stacked_beliefs = stacked_ghosts_beliefs_[begin_ghost];
+    float *stacked_probabilities = &stacked_beliefs.beliefs[0];
+    float *next_stacked_probabilities = &stacked_beliefs.next_beliefs[0];
+    BeliefSupport& stacked_support = stacked_beliefs.support;
+    BeliefSupport& next_stacked_support = stacked_beliefs.next_support;
+
+    std::vector<double> stop_probabilities (num_columns);
+    std::vector<double> move_probabilities (num_columns);
+    std::vector<float> random_probabilities (num_columns);
+    std::vector<int> spawn_cells (num_columns);
+    std::vector<double> total_chance_pacman_or_ghost_killed (num_columns, 0.0);
+
+    for (int column = 0 ; column < num_columns ; column++)
+    {
+        int ghost_index = begin_ghost + column;
 
-    std::vector<float> ghost_pose_map_line (width_, 0);
-    std::vector< std::vector<float> > ghost_new_pose_map (height_, ghost_pose_map_line);
+        // white ghosts move at half speed, so a ghost that is white with probability p stops with probability p/2
+        stop_probabilities[column] = white_ghost_timer_.getProbability(ghost_index)/2.0;
+        move_probabilities[column] = 1.0 - stop_probabilities[column];
 
-    std::vector< std::vector<float> > ghost_pose_map = ghosts_poses_map_[ghost_index];
-    double total_chance_pacman_or_ghost_killed = 0.0;
+        const geometry_msgs::Pose& ghost_spawn = ghosts_spawn_poses_[ghost_index];
+        spawn_cells[column] = (int) ghost_spawn.position.y * width_ + (int) ghost_spawn.position.x;
 
-    for (int i = 0 ; i < width_ ; i++)
-    {
-        for (int j = 0 ; j < height_ ; j++)
+        // the belief is moved into its column and zeroed, so the predicted one can be written back in place
+        ProbabilityGrid& ghost_pose_map = ghosts_poses_map_[ghost_index];
+        BeliefSupport& ghost_support = ghosts_supports_[ghost_index];
+        for (int k = 0 ; k < ghost_support.size() ; k++)
         {
-            if( map_[j][i] != WALL)
-            {
-                float probability_of_being_in_this_place = ghost_pose_map[j][i];
-
-                std::vector< std::pair<int, int> > next_positions = getLegalNextPositions(i, j);
-                float random_probability = (1.0 - STOP_PROBABILITY)/next_positions.size();
-
-                ghost_new_pose_map[j][i] += STOP_PROBABILITY * probability_of_being_in_this_place;
+            int cell = ghost_support.getCell(k);
+            stacked_probabilities[cell * num_columns + column] = ghost_pose_map.get(cell);
+            ghost_pose_map.set(cell, 0);
+            stacked_support.addCell(cell);
+        }
+        ghost_support.clear();
+    }
 
-                //ROS_INFO_STREAM("" << random_probability);
+    for (int k = 0 ; k < stacked_support.size() ; k++)
+    {
+        int cell = stacked_support.getCell(k);
+        const float *probabilities_of_being_in_this_place = &stacked_probabilities[cell * num_columns];
 
-                for(std::vector< std::pair<int, int> >::reverse_iterator it = next_positions.rbegin(); it != next_positions.rend(); ++it)
-                {
-                    /* std::cout << *it; ... */
-                    int x = it->first;
-                    int y = it->second;
-                    ghost_new_pose_map[y][x] += random_probability * probability_of_being_in_this_place;
+        // the random walk is the same for every ghost, the stop probability scales each column
+        int num_neighbours = transition_matrix_.getNumberOfNeighbours(cell);
+        float *next_probabilities = &next_stacked_probabilities[cell * num_columns];
+        for (int column = 0 ; column < num_columns ; column++)
+        {
+            random_probabilities[column] = move_probabilities[column]/num_neighbours;
+            next_probabilities[column] += stop_probabilities[column] * probabilities_of_being_in_this_place[column];
+        }
+        next_stacked_support.addCell(cell);
 
-                    // it can be done like this, without checking if ghost is white, 
-                    // because if pacman survives, it doesnt matter if moved the ghost
-                    for(int ghost_index = 0; ghost_index < num_ghosts_ ; ++ghost_index)
-                    {
-                        geometry_msgs::Pose ghost_spawn = ghosts_spawn_poses_[ghost_index];
-                        double chance_pacman_or_ghost_killed = ghost_new_pose_map[y][x] * pacman_pose_map_[y][x];
+        // last entry of the row is the cell itself, already handled as the stop move
+        int neighbours_end = transition_matrix_.getRowEnd(cell) - 1;
+        for (int entry = transition_matrix_.getRowBegin(cell) ; entry < neighbours_end ; entry++)
+        {
+            int next_cell = transition_matrix_.getTarget(entry);
+            next_probabilities = &next_stacked_probabilities[next_cell * num_columns];
+            for (int column = 0 ; column < num_columns ; column++)
+                next_probabilities[column] += random_probabilities[column] * probabilities_of_being_in_this_place[column];
+            next_stacked_support.addCell(next_cell);
+
+            // it can be done like this, without checking if ghost is white,
+            // because if pacman survives, it doesnt matter if moved the ghost
+            float probability_of_pacman_in_this_place = pacman_pose_map_.get(next_cell);
+            if (probability_of_pacman_in_this_place == 0)
+                continue;
+
+            for (int column = 0 ; column < num_columns ; column++)
+            {
+                int spawn_cell = spawn_cells[column];
+                double chance_pacman_or_ghost_killed = next_probabilities[column] * probability_of_pacman_in_this_place;
 
-                        ghost_new_pose_map[y][x] -= chance_pacman_or_ghost_killed;
-                        ghost_new_pose_map[ghost_spawn.position.y][ghost_spawn.position.x] += \
-                                        chance_pacman_or_ghost_killed;
+                next_probabilities[column] -= chance_pacman_or_ghost_killed;
+                next_stacked_probabilities[spawn_cell * num_columns + column] += chance_pacman_or_ghost_killed;
+                next_stacked_support.addCell(spawn_cell);
 
-                        total_chance_pacman_or_ghost_killed += chance_pacman_or_ghost_killed;
-                    }
-                }
+                total_chance_pacman_or_ghost_killed[column] += chance_pacman_or_ghost_killed;
             }
         }
     }
 
-    for(std::vector< std::vector<float> >::reverse_iterator it = probability_ghosts_white_.rbegin(); it != probability_ghosts_white_.rend(); ++it)
+    // back into each ghost belief, leaving both stacked matrices zeroed for the next tick
+    for (int k = 0 ; k < next_stacked_support.size() ; k++)
     {
-        (*it)[ghost_index] *= (1 - total_chance_pacman_or_ghost_killed);
+        int cell = next_stacked_support.getCell(k);
+        float *next_probabilities = &next_stacked_probabilities[cell * num_columns];
+        for (int column = 0 ; column < num_columns ; column++)
+        {
+            if (next_probabilities[column] != 0)
+            {
+                ghosts_poses_map_[begin_ghost + column].set(cell, next_probabilities[column]);
+                ghosts_supports_[begin_ghost + column].addCell(cell);
+                next_probabilities[column] = 0;
+            }
+        }
     }
+    for (int k = 0 ; k < stacked_support.size() ; k++)
+    {
+        float *probabilities = &stacked_probabilities[stacked_support.getCell(k) * num_columns];
+        std::fill(probabilities, probabilities + num_columns, 0);
+    }
+    stacked_support.clear();
+    next_stacked_support.clear();
 
-    ghosts_poses_map_[ghost_index].clear();
-    ghosts_poses_map_[ghost_index] = ghost_new_pose_map;
+    for (int column = 0 ; column < num_columns ; column++)
+    {
+        int ghost_index = begin_ghost + column;
+
+        white_ghost_timer_.scale(ghost_index, 1 - total_chance_pacman_or_ghost_killed[column]);
+        pruned_masses_[ghost_index + 1] += ghosts_supports_[ghost_index].prune(ghosts_poses_map_[ghost_index], pruning_threshold_);
+        is_ghost_most_probable_cell_valid_[ghost_index] = false;
+    }
 }
 
 void BayesianGameState::predictGhostsMoves()
 {
-    for(int i = 0 ; i < num_ghosts_ ; ++i)
-    {
-        predictGhostMove(i);
-    }
+    state_version_++;
+
+    task_scheduler_.parallelFor(0, num_ghosts_, 1, boost::bind(&BayesianGameState::predictGhostsBeliefs, this, _1, _2));
 }
 
 void BayesianGameState::predictAgentsMoves(pacman_msgs::PacmanAction action)
 {
-    predictPacmanMove(action);
-    predictGhostsMoves();
+    state_version_++;
+    std::fill(pruned_masses_.begin(), pruned_masses_.end(), 0.0);
+
+    // ghosts read the predicted pacman belief
+    predictPacmanBelief(action);
+    task_scheduler_.parallelFor(0, num_ghosts_, 1, boost::bind(&BayesianGameState::predictGhostsBeliefs, this, _1, _2));
 }
 
 bool BayesianGameState::isFinished()
@@ -362,56 +704,40 @@ bool BayesianGameState::isFinished()
 
 float BayesianGameState::getClosestFoodDistance()
 {
-    geometry_msgs::Pose new_pose = getMostProbablePacmanPose();
-    int new_x = new_pose.position.x;
-    int new_y = new_pose.position.y;
-
     float food_probability_threshold = getMaxFoodProbability()/2.0;
 
-    std::map< std::pair<int, int>, int > distances = getDistances(new_x, new_y);
+    const uint16_t *distances = getStepContext().getPacmanDistances();
 
-    int min_dist = util::INFINITE;
-
-    for (int i = 0 ; i < height_ ; i++) {
-        for (int j = 0 ; j < width_ ; j++) {
-            if(foods_map_[i][j] >= food_probability_threshold) {
-                int dist = distances[std::make_pair(j, i)];
-                if (dist < min_dist) {
-                    min_dist = dist;
-                }
-            }
-        }
-    }
+    int min_dist;
+    food_belief_.findClosestCell(food_probability_threshold, distances, util::INFINITE, min_dist);
 
     return min_dist;// / ( (float) height_ * width_);
 }
 
 float BayesianGameState::getClosestBigFoodDistance()
 {
-    geometry_msgs::Pose new_pose = getMostProbablePacmanPose();
-    int new_x = new_pose.position.x;
-    int new_y = new_pose.position.y;
-
     float food_probability_threshold = getMaxBigFoodProbability()/2.0;
 
-    std::map< std::pair<int, int>, int > distances = getDistances(new_x, new_y);
+    const uint16_t *distances = getStepContext().getPacmanDistances();
 
-    int min_dist = util::INFINITE;
-
-    for (int i = 0 ; i < height_ ; i++) {
-        for (int j = 0 ; j < width_ ; j++) {
-            if(big_foods_map_[i][j] >= food_probability_threshold) {
-                int dist = distances[std::make_pair(j, i)];
-                if (dist < min_dist) {
-                    min_dist = dist;
-                }
-            }
-        }
-    }
+    int min_dist;
+    big_food_belief_.findClosestCell(food_probability_threshold, distances, util::INFINITE, min_dist);
 
     return min_dist;
 }
 
+int BayesianGameState::findClosestFoodCell(int max_distance, int& min_distance)
+{
+    float food_probability_threshold = getMaxFoodProbability()/2.0;
+    return food_belief_.findClosestCell(food_probability_threshold, getStepContext().getPacmanDistances(), max_distance, min_distance);
+}
+
+int BayesianGameState::findClosestBigFoodCell(int max_distance, int& min_distance)
+{
+    float food_probability_threshold = getMaxBigFoodProbability()/2.0;
+    return big_food_belief_.findClosestCell(food_probability_threshold, getStepContext().getPacmanDistances(), max_distance, min_distance);
+}
+
 bool BayesianGameState::eatsFood(pacman_msgs::PacmanAction action)
 {
     geometry_msgs::Pose new_pose = getMostProbablePacmanPose();
@@ -430,14 +756,14 @@ int BayesianGameState::getClosestGhostDistance()
     int new_y = new_pose.position.y;
     std::vector< geometry_msgs::Pose > ghosts_poses = getMostProbableGhostsPoses();
 
-    std::map< std::pair<int, int>, int > distances = getDistances(new_x, new_y);
+    const uint16_t *distances = distance_matrix_.getDistanceRow(new_x, new_y);
 
     int min_dist = util::INFINITE;
 
     for(std::vector< geometry_msgs:: Pose >::reverse_iterator it = ghosts_poses.rbegin();
                              it != ghosts_poses.rend() ; ++it)
     {
-        int dist = distances[std::make_pair(it->position.x, it->position.y)];
+        int dist = distance_matrix_.distance(distances, it->position.x, it->position.y);
 
         if (dist < min_dist) {
             min_dist = dist;
@@ -475,16 +801,9 @@ double BayesianGameState::getProbOfWhiteGhosts()
 {
     double probability_white_ghost = 0;
 
-    std::vector<double> ghost_white_prob (num_ghosts_, 0.0);
-    for(std::vector< std::vector<float> >::reverse_iterator it = probability_ghosts_white_.rbegin(); it != probability_ghosts_white_.rend(); ++it)
-    {
-        for(int ghost_index = 0; ghost_index < num_ghosts_ ; ++ghost_index)
-            ghost_white_prob[ghost_index] += (*it)[ghost_index];
-    }
-
     for(int ghost_index = 0; ghost_index < num_ghosts_ ; ++ghost_index)
-        if ( probability_white_ghost < ghost_white_prob[ghost_index] )
-            probability_white_ghost = ghost_white_prob[ghost_index];
+        if ( probability_white_ghost < white_ghost_timer_.getProbability(ghost_index) )
+            probability_white_ghost = white_ghost_timer_.getProbability(ghost_index);
 
     return probability_white_ghost;
 }
@@ -517,7 +836,7 @@ int BayesianGameState::getNumberOfGhostsNStepsAway(int n)
     int new_x = pacman_pose.position.x;
     int new_y = pacman_pose.position.y;
 
-    std::map< std::pair<int, int>, int > distances = getDistances(new_x, new_y);
+    const uint16_t *distances = distance_matrix_.getDistanceRow(new_x, new_y);
 
     int number_ghost = 0;
 
@@ -525,7 +844,7 @@ int BayesianGameState::getNumberOfGhostsNStepsAway(int n)
                              it != ghosts_poses.rend() ; ++it)
     {
         //int dist = abs(new_x - it->position.x) + abs(new_y - it->position.y);
-        int dist = distances[std::make_pair(it->position.x, it->position.y)];
+        int dist = distance_matrix_.distance(distances, it->position.x, it->position.y);
 
         if (dist <= n) {
             number_ghost++;
@@ -543,50 +862,27 @@ bool BayesianGameState::hasGhostNStepsAway(int n)
 
 std::pair< double, double > BayesianGameState::getProbabilityOfAGhosWhiteOrNotNStepsAway(int n)
 {
+    ghosts_white_probabilities_.resize(num_ghosts_);
+    for(int ghost_index = 0; ghost_index < num_ghosts_ ; ++ghost_index)
+        ghosts_white_probabilities_[ghost_index] = white_ghost_timer_.getProbability(ghost_index);
+
+    const BallIndex& ball_index = getBallIndex(n);
     double probability_normal_ghost = 0;
     double probability_white_ghost = 0;
 
-    std::vector<float> ghost_normal_prob (num_ghosts_, 0.0);
-    std::vector<float> ghost_white_prob (num_ghosts_, 0.0);
-    for(std::vector< std::vector<float> >::reverse_iterator it = probability_ghosts_white_.rbegin(); it != probability_ghosts_white_.rend(); ++it)
+    for (int k = 0 ; k < pacman_support_.size() ; k++)
     {
-        for(int ghost_index = 0; ghost_index < num_ghosts_ ; ++ghost_index)
-            ghost_white_prob[ghost_index] += (*it)[ghost_index];
-    }
+        int cell = pacman_support_.getCell(k);
+        double probability_of_being_in_this_place = pacman_pose_map_.get(cell);
 
-    for(int ghost_index = 0; ghost_index < num_ghosts_ ; ++ghost_index)
-        ghost_normal_prob[ghost_index] = 1 - ghost_white_prob[ghost_index];
+        if (probability_of_being_in_this_place <= 0)
+            continue;
 
-    for (int i = 0 ; i < width_ ; i++)
-    {
-        for (int j = 0 ; j < height_ ; j++)
+        for(int ghost_index = 0; ghost_index < num_ghosts_ ; ++ghost_index)
         {
-            float probability_of_being_in_this_place = pacman_pose_map_[j][i];
-
-            if( map_[j][i] != WALL && probability_of_being_in_this_place > 0)
-            {
-                std::map< std::pair<int, int>, int > distances = getDistances(i, j);
-
-                int min_i = (i - n > 0) ? (i - n) : 0;
-                int min_j = (j - n > 0) ? (j - n) : 0;
-
-                for (int ghost_i = min_i ; ( (ghost_i - i) < n ) && ( ghost_i < width_ ) ; ghost_i++)
-                {
-                    for (int ghost_j = min_j ; ( (ghost_j - j) < n ) && ( ghost_j < height_ ) ; ghost_j++)
-                    {
-                        int dist = distances[std::make_pair(ghost_i, ghost_j)];
-
-                        if( dist < n && map_[ghost_j][ghost_i] != WALL)
-                        {
-                            for (int ghost_index = 0 ; ghost_index < num_ghosts_ ; ghost_index++)
-                            {
-                                probability_normal_ghost += probability_of_being_in_this_place * ghosts_poses_map_[ghost_index][ghost_j][ghost_i] * ghost_normal_prob[ghost_index];
-                                probability_white_ghost += probability_of_being_in_this_place * ghosts_poses_map_[ghost_index][ghost_j][ghost_i] * ghost_white_prob[ghost_index];
-                            }
-                        }
-                    }
-                }
-            }
+            double probability_ghost_near = probability_of_being_in_this_place * ball_index.sum(ghosts_poses_map_[ghost_index], cell);
+            probability_normal_ghost += probability_ghost_near * (1 - ghosts_white_probabilities_[ghost_index]);
+            probability_white_ghost += probability_ghost_near * ghosts_white_probabilities_[ghost_index];
         }
     }
 
@@ -605,161 +901,125 @@ double BayesianGameState::getProbabilityOfAWhiteGhostNStepsAway(int n)
     return probabilities.second;
 }
 
-std::map< std::pair<int, int>, int > BayesianGameState::calculateDistances(int x, int y)
+void BayesianGameState::precalculateAllDistances()
 {
-    std::map< std::pair<int, int>, int > distances;
-
-    distances[std::make_pair(x, y)] = 0;
-
-    int current_distance = 0;
-    bool done = false;
-
-    std::vector< std::pair<int, int> > legal_positions = getLegalNextPositions(x, y);
+    //ROS_DEBUG_STREAM("Pre-calculating all distances");
 
-    while(!done)
+    open_cells_ = std::vector<bool> (width_ * height_, false);
+    for (int j = 0 ; j < height_ ; j++)
     {
-        done = true;
-        current_distance++;
-        std::vector< std::pair<int, int> > next_legal_positions;
+        for (int i = 0 ; i < width_ ; i++)
+            open_cells_[j * width_ + i] = map_[j][i] != WALL;
+    }
 
-        for(std::vector< std::pair<int, int> >::reverse_iterator it = legal_positions.rbegin(); it != legal_positions.rend(); ++it)
-        {
-            if ( distances.find(*it) == distances.end() )
-            {
-                distances[*it] = current_distance;
-                done = false;
+    distance_matrix_ = DistanceMatrix(width_, height_, open_cells_, DistanceMatrix::getDefaultCacheDirectory());
 
-                std::vector< std::pair<int, int> > temp_legal_positions = getLegalNextPositions(it->first, it->second);
-                next_legal_positions.reserve(next_legal_positions.size() + temp_legal_positions.size());
-                next_legal_positions.insert(next_legal_positions.end(), temp_legal_positions.begin(), temp_legal_positions.end());
-            }
-        }
+    //ROS_DEBUG_STREAM("Pre-calculated all distances");
+}
 
-        legal_positions = next_legal_positions;
-    }
-    
-    return distances;
+const DistanceMatrix& BayesianGameState::getDistanceMatrix()
+{
+    return distance_matrix_;
 }
 
-void BayesianGameState::precalculateAllDistances()
+const BallIndex& BayesianGameState::getBallIndex(int n)
 {
-    //ROS_DEBUG_STREAM("Pre-calculating all distances");
+    if (n >= (int) ball_indexes_.size())
+        ball_indexes_.resize(n + 1);
 
-    for (int i = 0 ; i < width_ ; i++)
-    {
-        for (int j = 0 ; j < height_ ; j++)
-        {
-            if( map_[j][i] != WALL )
-            {
-                precalculated_distances_[std::make_pair(i, j)] = calculateDistances(i, j);
-            }
-        }
-    }
+    if (ball_indexes_[n].isEmpty())
+        ball_indexes_[n] = BallIndex(distance_matrix_, open_cells_, n);
 
-    //ROS_DEBUG_STREAM("Pre-calculated all distances");
+    return ball_indexes_[n];
 }
 
-std::map< std::pair<int, int>, int > BayesianGameState::getDistances(int x, int y)
+StepContext<BayesianGameState>& BayesianGameState::getStepContext()
 {
-    std::map< std::pair<int, int>, int > distances = precalculated_distances_[std::make_pair(x, y)];
-    
-    return distances;
+    step_context_.update(this);
+    return step_context_;
 }
 
 float BayesianGameState::getMaxFoodProbability()
 {
-    double max_probability = -util::INFINITE;
-
-    for (int i = 0 ; i < width_ ; i++)
+    if (!is_max_food_probability_valid_)
     {
-        for (int j = 0 ; j < height_ ; j++)
-        {
-            double probability = this->foods_map_[j][i];
-            if (probability > max_probability)
-            {
-                max_probability = probability;
-            }
-        }
+        max_food_probability_ = food_belief_.getMaxProbability();
+        is_max_food_probability_valid_ = true;
     }
 
-    return max_probability;
+    return max_food_probability_;
 }
 
 float BayesianGameState::getMaxBigFoodProbability()
 {
-    double max_probability = -util::INFINITE;
-
-    for (int i = 0 ; i < width_ ; i++)
+    if (!is_max_big_food_probability_valid_)
     {
-        for (int j = 0 ; j < height_ ; j++)
-        {
-            double probability = this->big_foods_map_[j][i];
-            if (probability > max_probability)
-            {
-                max_probability = probability;
-            }
-        }
+        max_big_food_probability_ = big_food_belief_.getMaxProbability();
+        is_max_big_food_probability_valid_ = true;
     }
 
-    return max_probability;
+    return max_big_food_probability_;
 }
 
-geometry_msgs::Pose BayesianGameState::getMostProbablePacmanPose()
+bool BayesianGameState::isSweptBefore(int cell, int other_cell)
 {
-    geometry_msgs::Pose probable_pose;
+    int x = cell % width_;
+    int other_x = other_cell % width_;
 
-    int probable_x = -1;
-    int probable_y = -1;
+    return ( x < other_x ) || ( x == other_x && cell < other_cell );
+}
+
+int BayesianGameState::findMostProbableCell(const ProbabilityGrid& pose_map, BeliefSupport& support)
+{
+    int most_probable_cell = -1;
     double max_probability = -util::INFINITE;
 
-    for (int i = 0 ; i < width_ ; i++)
+    // ties are broken by lowest x and then lowest y
+    for (int k = 0 ; k < support.size() ; k++)
     {
-        for (int j = 0 ; j < height_ ; j++)
-        {
-            double probability = this->pacman_pose_map_[j][i];
-            if (probability > max_probability)
-            {
-                probable_x = i;
-                probable_y = j;
+        int cell = support.getCell(k);
 
-                max_probability = probability;
-            }
+        double probability = pose_map.get(cell);
+        if (probability > max_probability || ( probability == max_probability && isSweptBefore(cell, most_probable_cell) ) )
+        {
+            most_probable_cell = cell;
+            max_probability = probability;
         }
     }
 
-    probable_pose.position.x = probable_x;
-    probable_pose.position.y = probable_y;
-
-    return probable_pose;
+    return most_probable_cell;
 }
 
-geometry_msgs::Pose BayesianGameState::getMostProbableGhostPose(int ghost_index)
+geometry_msgs::Pose BayesianGameState::getCellPose(int cell)
 {
-    geometry_msgs::Pose probable_pose;
+    geometry_msgs::Pose pose;
 
-    int probable_x = -1;
-    int probable_y = -1;
-    double max_probability = -util::INFINITE;
+    pose.position.x = (cell < 0) ? -1 : cell % width_;
+    pose.position.y = (cell < 0) ? -1 : cell / width_;
 
-    for (int i = 0 ; i < width_ ; i++)
-    {
-        for (int j = 0 ; j < height_ ; j++)
-        {
-            double probability = this->ghosts_poses_map_[ghost_index][j][i];
-            if (probability > max_probability)
-            {
-                probable_x = i;
-                probable_y = j;
+    return pose;
+}
 
-                max_probability = probability;
-            }
-        }
+geometry_msgs::Pose BayesianGameState::getMostProbablePacmanPose()
+{
+    if (!is_pacman_most_probable_cell_valid_)
+    {
+        pacman_most_probable_cell_ = findMostProbableCell(pacman_pose_map_, pacman_support_);
+        is_pacman_most_probable_cell_valid_ = true;
     }
 
-    probable_pose.position.x = probable_x;
-    probable_pose.position.y = probable_y;
+    return getCellPose(pacman_most_probable_cell_);
+}
+
+geometry_msgs::Pose BayesianGameState::getMostProbableGhostPose(int ghost_index)
+{
+    if (!is_ghost_most_probable_cell_valid_[ghost_index])
+    {
+        ghosts_most_probable_cells_[ghost_index] = findMostProbableCell(ghosts_poses_map_[ghost_index], ghosts_supports_[ghost_index]);
+        is_ghost_most_probable_cell_valid_[ghost_index] = true;
+    }
 
-    return probable_pose;
+    return getCellPose(ghosts_most_probable_cells_[ghost_index]);
 }
 
 std::vector< geometry_msgs::Pose > BayesianGameState::getMostProbableGhostsPoses()
@@ -9,6 +9,7 @@
 #include "bayesian_q_5_behaviors/bayesian_game_state_5_behaviors.h"
 #include "bayesian_q_5_behaviors/bayesian_5_behaviors_agent.h"
 #include "bayesian_q_5_behaviors/bayesian_q_learning_5_behaviors.h"
+#include "pacman_abstract_classes/random_stream.h"
 
 #include <mcheck.h>
 
@@ -16,6 +17,12 @@ int NUMBER_OF_GAMES_WITH_NO_GUI = 0;
 int NUMBER_OF_GAMES = 2000;
 int NUMBER_OF_TRAININGS = 0;
 bool is_training = true;
+// seed of the first match, the following ones add the number of matches played, 0 takes it from the clock
+uint64_t RANDOM_SEED = 0;
+// belief cells below this probability are pruned, 0 keeps the full beliefs
+float BELIEF_PRUNING_THRESHOLD = 0;
+// QUANTIZED_BELIEFS keeps the beliefs in 16 bits per cell
+BayesianGameState::BeliefStorage BELIEF_STORAGE = BayesianGameState::FLOAT_BELIEFS;
 
 bool endGame(pacman_msgs::EndGame::Request &req, pacman_msgs::EndGame::Response &res, 
         ros::ServiceClient *start_game_client, BayesianGameState **game_state, BayesianQLearning *q_learning)
@@ -50,8 +57,8 @@ bool endGame(pacman_msgs::EndGame::Request &req, pacman_msgs::EndGame::Response
             if(start_game.response.started)
             {
                 // new game started
-                delete *game_state;
-                *game_state = new BayesianGameState;
+                RandomStream::setMatchSeed(RANDOM_SEED + game_count);
+                (*game_state)->reset();
                 res.game_restarted = true;
 
                 //ROS_INFO("New game started");
@@ -122,8 +129,11 @@ int main(int argc, char **argv)
     ros::NodeHandle n;
     ros::Rate loop_rate(1);
 
-    srand (time(NULL)); // start random fucntions
-    BayesianGameState *game_state = new BayesianGameState;
+    if (!RANDOM_SEED)
+        RANDOM_SEED = time(NULL);
+    RandomStream::setMatchSeed(RANDOM_SEED);
+    BayesianGameState *game_state = new BayesianGameState(BELIEF_STORAGE);
+    game_state->setPruningThreshold(BELIEF_PRUNING_THRESHOLD);
     BayesianBehaviorAgent pacman;
     BayesianQLearning *q_learning = new BayesianQLearning;
 
@@ -2,6 +2,10 @@
 #define BAYESIAN_GAME_STATE_H
 
 #include "q_learning_pacman/game_state.h"
+#include "q_learning_pacman/step_context.h"
+#include "pacman_abstract_classes/observation_engine.h"
+#include "pacman_abstract_classes/distance_matrix.h"
+#include "pacman_abstract_classes/ball_index.h"
 
 #include "geometry_msgs/Pose.h"
 #include "pacman_msgs/AgentPoseService.h"
@@ -22,14 +26,25 @@ class BayesianGameState : public GameState
     ros::ServiceServer pacman_observer_service_;
     ros::ServiceServer ghost_distance_observer_service_;
 
+    ObservationEngine ghost_distance_observation_engine_;
+
     // precalculate all real distances in map
-    std::map< std::pair<int, int>, std::map< std::pair<int, int>, int > > precalculated_distances_;
-    std::map< std::pair<int, int>, int > calculateDistances(int x, int y);
+    DistanceMatrix distance_matrix_;
+    std::vector<bool> open_cells_;
     void precalculateAllDistances();
 
+    // cells closer than n to each cell, indexed by n and built the first time n is used
+    std::vector< BallIndex > ball_indexes_;
+    const BallIndex& getBallIndex(int n);
+
+    // values shared by the learner and the behaviors in the current tick
+    StepContext<BayesianGameState> step_context_;
+
   public:
     BayesianGameState();
     ~BayesianGameState();
+
+    void reset();
     
     void predictPacmanMove(pacman_msgs::PacmanAction action);
     void predictGhostMove(int ghost_index);
@@ -53,7 +68,8 @@ class BayesianGameState : public GameState
     std::vector< geometry_msgs::Pose > getMostProbableGhostsPoses();
 
     // usefull functions
-    std::map< std::pair<int, int>, int > getDistances(int x, int y);
+    const DistanceMatrix& getDistanceMatrix();
+    StepContext<BayesianGameState>& getStepContext();
 };
 
 #endif // BAYESIAN_GAME_STATE_H
\ No newline at end of file
@@ -9,6 +9,7 @@
 #include "bayesian_q_learning/bayesian_game_state.h"
 #include "bayesian_q_learning/bayesian_behavior_agent.h"
 #include "bayesian_q_learning/bayesian_q_learning.h"
+#include "pacman_abstract_classes/random_stream.h"
 
 #include <mcheck.h>
 
@@ -16,6 +17,8 @@ int NUMBER_OF_GAMES_WITH_NO_GUI = 1000;
 int NUMBER_OF_GAMES = 1500;
 int NUMBER_OF_TRAININGS = 700;
 bool is_training = true;
+// seed of the first match, the following ones add the number of matches played, 0 takes it from the clock
+uint64_t RANDOM_SEED = 0;
 
 bool endGame(pacman_msgs::EndGame::Request &req, pacman_msgs::EndGame::Response &res, 
         ros::ServiceClient *start_game_client, BayesianGameState **game_state, BayesianQLearning *q_learning)
@@ -50,8 +53,8 @@ bool endGame(pacman_msgs::EndGame::Request &req, pacman_msgs::EndGame::Response
             if(start_game.response.started)
             {
                 // new game started
-                delete *game_state;
-                *game_state = new BayesianGameState;
+                RandomStream::setMatchSeed(RANDOM_SEED + game_count);
+                (*game_state)->reset();
                 res.game_restarted = true;
 
                 ROS_INFO("New game started");
@@ -114,7 +117,9 @@ int main(int argc, char **argv)
     ros::NodeHandle n;
     ros::Rate loop_rate(1);
 
-    srand (time(NULL)); // start random fucntions
+    if (!RANDOM_SEED)
+        RANDOM_SEED = time(NULL);
+    RandomStream::setMatchSeed(RANDOM_SEED);
     BayesianGameState *game_state = new BayesianGameState;
     BayesianBehaviorAgent pacman;
     BayesianQLearning *q_learning = new BayesianQLearning;
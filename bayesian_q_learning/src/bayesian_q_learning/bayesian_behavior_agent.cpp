@@ -57,16 +57,18 @@ pacman_msgs::PacmanAction BayesianBehaviorAgent::getHuntAction(BayesianGameState
 pacman_msgs::PacmanAction BayesianBehaviorAgent::getRunAction(BayesianGameState *game_state) {
     pacman_msgs::PacmanAction action;
 
-    geometry_msgs::Pose pacman_pose = game_state->getMostProbablePacmanPose();
-    std::map< std::pair<int, int>, int > distances = game_state->getDistances(pacman_pose.position.x, pacman_pose.position.y);
+    StepContext<BayesianGameState>& step_context = game_state->getStepContext();
+    const geometry_msgs::Pose& pacman_pose = step_context.getPacmanPose();
+    const DistanceMatrix& distance_matrix = game_state->getDistanceMatrix();
+    const uint16_t *distances = step_context.getPacmanDistances();
 
     int min_distance = util::MAX_DISTANCE;
 
-    std::vector< geometry_msgs::Pose > ghosts_poses = game_state->getMostProbableGhostsPoses();
+    std::vector< geometry_msgs::Pose > ghosts_poses = step_context.getGhostsPoses();
     std::vector< geometry_msgs::Pose >::reverse_iterator closest_ghost;
     for(std::vector< geometry_msgs::Pose >::reverse_iterator it = ghosts_poses.rbegin(); it != ghosts_poses.rend(); ++it) {
         /* std::cout << *it; ... */
-        int distance = distances[std::make_pair(it->position.x, it->position.y)];
+        int distance = distance_matrix.distance(distances, it->position.x, it->position.y);
         if(distance != 0 && distance < min_distance)
         {
             closest_ghost = it;
@@ -77,15 +79,15 @@ pacman_msgs::PacmanAction BayesianBehaviorAgent::getRunAction(BayesianGameState
     //game_state->printMap();
     //ROS_INFO_STREAM("x: " << closest_ghost->position.x << " y: " << closest_ghost->position.y );
 
-    distances = game_state->getDistances(closest_ghost->position.x, closest_ghost->position.y);
+    distances = distance_matrix.getDistanceRow(closest_ghost->position.x, closest_ghost->position.y);
     std::vector< pacman_msgs::PacmanAction > actions = game_state->getLegalActions(pacman_pose.position.x, pacman_pose.position.y);
     std::vector< std::pair<int, int> > next_positions = game_state->getLegalNextPositions(pacman_pose.position.x, pacman_pose.position.y);
 
     int action_iterator = 0;
     for(int i = next_positions.size() - 1; i != -1; i--)
     {
-        //ROS_INFO_STREAM("- distance " << (short) actions[i].action << " : " << distances[ next_positions[i] ] );
-        if ( distances[ next_positions[i] ] > min_distance )
+        //ROS_INFO_STREAM("- distance " << (short) actions[i].action << " : " << distance_matrix.distance(distances, next_positions[i].first, next_positions[i].second) );
+        if ( distance_matrix.distance(distances, next_positions[i].first, next_positions[i].second) > min_distance )
         {
             action_iterator = i;
             break;
@@ -104,9 +106,11 @@ pacman_msgs::PacmanAction BayesianBehaviorAgent::getEatBigFoodAction(BayesianGam
 pacman_msgs::PacmanAction BayesianBehaviorAgent::getEatAction(BayesianGameState *game_state) {
     pacman_msgs::PacmanAction action;
 
-    geometry_msgs::Pose pacman_pose = game_state->getMostProbablePacmanPose();
-    std::map< std::pair<int, int>, int > distances = game_state->getDistances(pacman_pose.position.x, pacman_pose.position.y);
-    std::vector< std::vector<float> > foods_map = game_state->getFoodMap();
+    StepContext<BayesianGameState>& step_context = game_state->getStepContext();
+    const geometry_msgs::Pose& pacman_pose = step_context.getPacmanPose();
+    const DistanceMatrix& distance_matrix = game_state->getDistanceMatrix();
+    const uint16_t *distances = step_context.getPacmanDistances();
+    const ProbabilityGrid& foods_map = game_state->getFoodMap();
     float food_probability_threshold = game_state->getMaxFoodProbability()/2.0;
 
     int width = game_state->getWidth();
@@ -121,7 +125,7 @@ pacman_msgs::PacmanAction BayesianBehaviorAgent::getEatAction(BayesianGameState
         {
             if( foods_map[j][i] >= food_probability_threshold)
             {
-                int distance = distances[std::make_pair(i, j)];
+                int distance = distance_matrix.distance(distances, i, j);
                 if(distance < min_distance)
                 {
                     food_x = i;
@@ -132,14 +136,14 @@ pacman_msgs::PacmanAction BayesianBehaviorAgent::getEatAction(BayesianGameState
         }
     }
 
-    distances = game_state->getDistances(food_x, food_y);
+    distances = distance_matrix.getDistanceRow(food_x, food_y);
     std::vector< pacman_msgs::PacmanAction > actions = game_state->getLegalActions(pacman_pose.position.x, pacman_pose.position.y);
     std::vector< std::pair<int, int> > next_positions = game_state->getLegalNextPositions(pacman_pose.position.x, pacman_pose.position.y);
 
     int action_iterator = 0;
     for(int i = next_positions.size() - 1; i != -1; i--)
     {
-        if ( distances[ next_positions[i] ] < min_distance )
+        if ( distance_matrix.distance(distances, next_positions[i].first, next_positions[i].second) < min_distance )
         {
             action_iterator = i;
             break;
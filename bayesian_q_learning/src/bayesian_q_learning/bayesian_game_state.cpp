@@ -1,10 +1,12 @@
 #include "bayesian_q_learning/bayesian_game_state.h"
 
 #include "pacman_abstract_classes/util_functions.h"
+#include "pacman_abstract_classes/likelihood_table.h"
+#include <algorithm>
 #include <boost/math/special_functions/round.hpp>
 
 
-BayesianGameState::BayesianGameState()
+BayesianGameState::BayesianGameState() : ghost_distance_observation_engine_(0.5)
 {
     pacman_observer_service_ = n_.advertiseService<pacman_msgs::AgentPoseService::Request, pacman_msgs::AgentPoseService::Response>
                                 ("/pacman/pacman_pose/error", boost::bind(&BayesianGameState::observeAgent, this, _1, _2));
@@ -20,56 +22,47 @@ BayesianGameState::~BayesianGameState()
     pacman_observer_service_.shutdown();
     ghost_distance_observer_service_.shutdown();
 
-    precalculated_distances_.clear();
 
     ROS_INFO_STREAM("Bayesian game state destroyed");
 }
 
+void BayesianGameState::reset()
+{
+    GameState::reset();
+    is_finished_ = false;
+}
+
 void BayesianGameState::observePacman(double measurement_x, double measurement_y)
 {
+    state_version_++;
+
     float SD_PACMAN_MEASUREMENT = 0.5;
 
-    std::vector<float> pacman_pose_map_line (width_, 0);
-    std::vector< std::vector<float> > pacman_new_pose_map (height_, pacman_pose_map_line);
-    float sum_probabilities = 0.0;
+    // the gaussian is separable, so each cell likelihood is the product of its column and row weights
+    const LikelihoodTable& likelihood_table = LikelihoodTable::getTable(SD_PACMAN_MEASUREMENT, std::max(width_, height_));
+    std::vector<double> x_weights, y_weights;
+    likelihood_table.getAxisWeights(measurement_x, width_, x_weights);
+    likelihood_table.getAxisWeights(measurement_y, height_, y_weights);
 
-    for (int i = 0 ; i < width_ ; i++)
+    ProbabilityGrid likelihood_map (width_, height_);
+
+    for (int j = 0 ; j < height_ ; j++)
     {
-        for (int j = 0 ; j < height_ ; j++)
+        for (int i = 0 ; i < width_ ; i++)
         {
             if( map_[j][i] != WALL)
-            {
-                float old_probability_of_being_in_this_place = pacman_pose_map_[j][i];
-                float probability_of_place_given_z = util::getProbOfMeasurementGivenPosition(i, j, measurement_x, measurement_y, SD_PACMAN_MEASUREMENT);
-
-                //ROS_INFO_STREAM("" << random_probability);
-                pacman_new_pose_map[j][i] = probability_of_place_given_z * old_probability_of_being_in_this_place;
-
-                sum_probabilities += pacman_new_pose_map[j][i];
-            }
+                likelihood_map[j][i] = x_weights[i] * y_weights[j];
         }
     }
 
-    for (int i = 0 ; i < width_ ; i++)
+    pacman_pose_map_.multiply(likelihood_map);
+
+    if(!pacman_pose_map_.normalize())
     {
-        for (int j = 0 ; j < height_ ; j++)
-        {
-            if( map_[j][i] != WALL)
-            {
-                if(sum_probabilities != 0)
-                    pacman_new_pose_map[j][i] = pacman_new_pose_map[j][i]/sum_probabilities;
-                else
-                {
-                    ROS_WARN_STREAM_THROTTLE(1, "Probability 0 for pacman, redistributing");
-                    pacman_new_pose_map[j][i] = 1.0 / (float) ( height_ * width_ );
-                }
-            }
-        }
+        ROS_WARN_STREAM_THROTTLE(1, "Probability 0 for pacman, redistributing");
+        pacman_pose_map_.fillOpenCells(1.0 / (float) ( height_ * width_ ));
     }
 
-    pacman_pose_map_.clear();
-    pacman_pose_map_ = pacman_new_pose_map;
-
     int measurement_x_int = boost::math::iround(measurement_x);
     int measurement_y_int = boost::math::iround(measurement_y);
 
@@ -87,58 +80,19 @@ void BayesianGameState::observePacman(double measurement_x, double measurement_y
 
 void BayesianGameState::observeGhost(double measurement_x_dist, double measurement_y_dist, int ghost_index)
 {
-    double SD_GHOST_DIST_MEASUREMENT = 0.5;
+    state_version_++;
 
-    std::vector< std::vector<float> > ghost_pose_map = ghosts_poses_map_[ghost_index];
+    ProbabilityGrid likelihood_map = ghost_distance_observation_engine_.getRelativeMeasurementLikelihood(
+                                pacman_pose_map_, measurement_x_dist, measurement_y_dist);
 
-    std::vector<float> ghost_pose_map_line (width_, 0);
-    std::vector< std::vector<float> > ghost_new_pose_map (height_, ghost_pose_map_line);
-    float sum_probabilities = 0.0;
+    ProbabilityGrid& ghost_pose_map = ghosts_poses_map_[ghost_index];
+    ghost_pose_map.multiply(likelihood_map);
 
-    for (int i = 0 ; i < width_ ; i++)
-    {
-        for (int j = 0 ; j < height_ ; j++)
-        {
-            if( map_[j][i] != WALL)
-            {
-                float old_probability_of_being_in_this_place = ghost_pose_map[j][i];
-                for (int pacman_i = 0 ; pacman_i < width_ ; pacman_i++)
-                {
-                    for (int pacman_j = 0 ; pacman_j < height_ ; pacman_j++)
-                    {
-                        float probability_of_pacman = pacman_pose_map_[pacman_j][pacman_i];
-                        float probability_of_place_given_z = util::getProbOfMeasurementGivenPosition(i - pacman_i, j - pacman_j, measurement_x_dist, measurement_y_dist, SD_GHOST_DIST_MEASUREMENT);
-
-                        //ROS_INFO_STREAM("" << random_probability);
-                        ghost_new_pose_map[j][i] += probability_of_place_given_z * old_probability_of_being_in_this_place * probability_of_pacman;
-                    }
-                }
-                sum_probabilities += ghost_new_pose_map[j][i];
-            }
-        }
-    }
-
-    if(sum_probabilities == 0)
+    if(!ghost_pose_map.normalize())
     {
         ROS_WARN_STREAM("Probability 0 for ghost " << ghost_index << ", redistributing");
+        ghost_pose_map.fillOpenCells(1.0 / (float) ( height_ * width_ ));
     }
-
-    for (int i = 0 ; i < width_ ; i++)
-    {
-        for (int j = 0 ; j < height_ ; j++)
-        {
-            if( map_[j][i] != WALL)
-            {
-                if(sum_probabilities != 0)
-                    ghost_new_pose_map[j][i] = ghost_new_pose_map[j][i]/sum_probabilities;
-                else
-                    ghost_new_pose_map[j][i] = 1.0 / (float) ( height_ * width_ );
-            }
-        }
-    }
-
-    ghosts_poses_map_[ghost_index].clear();
-    ghosts_poses_map_[ghost_index] = ghost_new_pose_map;
 }
 
 bool BayesianGameState::observeAgent(pacman_msgs::AgentPoseService::Request &req, pacman_msgs::AgentPoseService::Response &res)
@@ -168,55 +122,22 @@ bool BayesianGameState::observeAgent(pacman_msgs::AgentPoseService::Request &req
 
 void BayesianGameState::predictPacmanMove(pacman_msgs::PacmanAction action)
 {
-    ROS_DEBUG_STREAM("Predict pacman");
-
-    std::vector<float> map_line (width_, 0);
-    std::vector< std::vector<float> > pacman_new_pose_map (height_, map_line);
-    std::vector< std::vector<float> > new_foods_map (height_, map_line);
-    map_line.clear();
-
-    for (int i = 0 ; i < width_ ; i++)
-    {
-        for (int j = 0 ; j < height_ ; j++)
-        {
-            if( map_[j][i] != WALL)
-            {
-                float probability_of_being_in_this_place = pacman_pose_map_[j][i];
-
-                std::vector< std::pair< float, std::pair<int, int> > > next_positions = getNextPositionsForActionWithProbabilities(i, j, action);
-
-                //ROS_INFO_STREAM("" << random_probability);
+    state_version_++;
 
-                for(std::vector< std::pair< float, std::pair<int, int> > >::reverse_iterator it = next_positions.rbegin(); it != next_positions.rend(); ++it)
-                {
-                    /* std::cout << *it; ... */
-                    float probability_of_move = it->first;
-                    int x = it->second.first;
-                    int y = it->second.second;
-                    pacman_new_pose_map[y][x] += probability_of_move * probability_of_being_in_this_place;
+    ROS_DEBUG_STREAM("Predict pacman");
 
+    ProbabilityGrid pacman_new_pose_map (width_, height_);
+    pacman_new_pose_map.setOpenCellsMask(open_cells_mask_);
 
-                }
-            }
-        }
-    }
-
-    for (int i = 0 ; i < width_ ; i++)
-    {
-        for (int j = 0 ; j < height_ ; j++)
-        {
-            if( map_[j][i] != WALL)
-            {
-                new_foods_map[j][i] = foods_map_[j][i] * ( 1 - pacman_new_pose_map[j][i]);
-            }
-        }
-    }
+    transition_matrix_.predictActionMove(pacman_pose_map_, action.action, pacman_new_pose_map);
 
-    pacman_pose_map_.clear();
-    pacman_pose_map_ = pacman_new_pose_map;
+    pacman_pose_map_.swap(pacman_new_pose_map);
 
-    foods_map_.clear();
-    foods_map_ = new_foods_map;
+    // food survives with the chance pacman is not over it
+    const float *pacman_probabilities = pacman_pose_map_.data();
+    float *food_probabilities = foods_map_.data();
+    for (int cell = 0 ; cell < foods_map_.getSize() ; cell++)
+        food_probabilities[cell] = food_probabilities[cell] * ( 1 - pacman_probabilities[cell]);
 
     //printPacmanOrGhostPose(true, 0);
     //ROS_INFO_STREAM("Foods map");
@@ -225,43 +146,20 @@ void BayesianGameState::predictPacmanMove(pacman_msgs::PacmanAction action)
 
 void BayesianGameState::predictGhostMove(int ghost_index)
 {
+    state_version_++;
+
     ROS_DEBUG_STREAM("Predict ghost " << ghost_index);
 
     double STOP_PROBABILITY = 0.2;
 
-    std::vector<float> ghost_pose_map_line (width_, 0);
-    std::vector< std::vector<float> > ghost_new_pose_map (height_, ghost_pose_map_line);
+    ProbabilityGrid ghost_new_pose_map (width_, height_);
+    ghost_new_pose_map.setOpenCellsMask(open_cells_mask_);
 
-    std::vector< std::vector<float> > ghost_pose_map = ghosts_poses_map_[ghost_index];
+    const ProbabilityGrid& ghost_pose_map = ghosts_poses_map_[ghost_index];
 
-    for (int i = 0 ; i < width_ ; i++)
-    {
-        for (int j = 0 ; j < height_ ; j++)
-        {
-            if( map_[j][i] != WALL)
-            {
-                float probability_of_being_in_this_place = ghost_pose_map[j][i];
-
-                std::vector< std::pair<int, int> > next_positions = getLegalNextPositions(i, j);
-                float random_probability = (1.0 - STOP_PROBABILITY)/next_positions.size();
-
-                ghost_new_pose_map[j][i] += STOP_PROBABILITY * probability_of_being_in_this_place;
-
-                //ROS_INFO_STREAM("" << random_probability);
-
-                for(std::vector< std::pair<int, int> >::reverse_iterator it = next_positions.rbegin(); it != next_positions.rend(); ++it)
-                {
-                    /* std::cout << *it; ... */
-                    int x = it->first;
-                    int y = it->second;
-                    ghost_new_pose_map[y][x] += random_probability * probability_of_being_in_this_place;
-                }
-            }
-        }
-    }
+    transition_matrix_.predictRandomMove(ghost_pose_map, STOP_PROBABILITY, ghost_new_pose_map);
 
-    ghosts_poses_map_[ghost_index].clear();
-    ghosts_poses_map_[ghost_index] = ghost_new_pose_map;
+    ghosts_poses_map_[ghost_index].swap(ghost_new_pose_map);
 }
 
 void BayesianGameState::predictGhostsMoves()
@@ -286,20 +184,16 @@ bool BayesianGameState::isFinished()
 // TODO: dividing by map width*height
 float BayesianGameState::getClosestFoodDistance()
 {
-    geometry_msgs::Pose new_pose = getMostProbablePacmanPose();
-    int new_x = new_pose.position.x;
-    int new_y = new_pose.position.y;
-
     float food_probability_threshold = getMaxFoodProbability()/2.0;
 
-    std::map< std::pair<int, int>, int > distances = getDistances(new_x, new_y);
+    const uint16_t *distances = getStepContext().getPacmanDistances();
 
     int min_dist = util::INFINITE;
 
     for (int i = 0 ; i < height_ ; i++) {
         for (int j = 0 ; j < width_ ; j++) {
             if(foods_map_[i][j] >= food_probability_threshold) {
-                int dist = distances[std::make_pair(j, i)];
+                int dist = distance_matrix_.distance(distances, j, i);
                 if (dist < min_dist) {
                     min_dist = dist;
                 }
@@ -328,14 +222,14 @@ int BayesianGameState::getClosestGhostDistance()
     int new_y = new_pose.position.y;
     std::vector< geometry_msgs::Pose > ghosts_poses = getMostProbableGhostsPoses();
 
-    std::map< std::pair<int, int>, int > distances = getDistances(new_x, new_y);
+    const uint16_t *distances = distance_matrix_.getDistanceRow(new_x, new_y);
 
     int min_dist = util::INFINITE;
 
     for(std::vector< geometry_msgs:: Pose >::reverse_iterator it = ghosts_poses.rbegin();
                              it != ghosts_poses.rend() ; ++it)
     {
-        int dist = distances[std::make_pair(it->position.x, it->position.y)];
+        int dist = distance_matrix_.distance(distances, it->position.x, it->position.y);
 
         if (dist < min_dist) {
             min_dist = dist;
@@ -392,7 +286,7 @@ int BayesianGameState::getNumberOfGhostsNStepsAway(int n)
     int new_x = pacman_pose.position.x;
     int new_y = pacman_pose.position.y;
 
-    std::map< std::pair<int, int>, int > distances = getDistances(new_x, new_y);
+    const uint16_t *distances = distance_matrix_.getDistanceRow(new_x, new_y);
 
     int number_ghost = 0;
 
@@ -400,7 +294,7 @@ int BayesianGameState::getNumberOfGhostsNStepsAway(int n)
                              it != ghosts_poses.rend() ; ++it)
     {
         //int dist = abs(new_x - it->position.x) + abs(new_y - it->position.y);
-        int dist = distances[std::make_pair(it->position.x, it->position.y)];
+        int dist = distance_matrix_.distance(distances, it->position.x, it->position.y);
 
         if (dist <= n) {
             number_ghost++;
@@ -420,174 +314,84 @@ float BayesianGameState::getProbabilityOfAGhostNStepsAway(int n)
 {
     double probability = 0;
 
-    for (int i = 0 ; i < width_ ; i++)
-    {
-        for (int j = 0 ; j < height_ ; j++)
-        {
-            if( map_[j][i] != WALL)
-            {
-                float probability_of_being_in_this_place = pacman_pose_map_[j][i];
-                std::map< std::pair<int, int>, int > distances = getDistances(i, j);
-
-                int min_i = (i - n > 0) ? (i - n) : 0;
-                int min_j = (j - n > 0) ? (j - n) : 0;
-
-                for (int ghost_i = min_i ; ( (ghost_i - i) < n ) && ( ghost_i < width_ ) ; ghost_i++)
-                {
-                    for (int ghost_j = min_j ; ( (ghost_j - j) < n ) && ( ghost_j < height_ ) ; ghost_j++)
-                    {
-                        int dist = distances[std::make_pair(ghost_i, ghost_j)];
-
-                        if( dist < n && map_[ghost_j][ghost_i] != WALL)
-                        {
-                            for (int ghost_index = 0 ; ghost_index < num_ghosts_ ; ghost_index++)
-                            {
-                                probability += probability_of_being_in_this_place * ghosts_poses_map_[ghost_index][ghost_j][ghost_i];
-                            }
-                        }
-                    }
-                }
-            }
-        }
-    }
-
-    return probability;
-}
+    const BallIndex& ball_index = getBallIndex(n);
+    const float *pacman_probabilities = pacman_pose_map_.data();
 
-std::map< std::pair<int, int>, int > BayesianGameState::calculateDistances(int x, int y)
-{
-    std::map< std::pair<int, int>, int > distances;
-
-    distances[std::make_pair(x, y)] = 0;
-
-    int current_distance = 0;
-    bool done = false;
-
-    std::vector< std::pair<int, int> > legal_positions = getLegalNextPositions(x, y);
-
-    while(!done)
+    for (int cell = 0 ; cell < width_ * height_ ; cell++)
     {
-        done = true;
-        current_distance++;
-        std::vector< std::pair<int, int> > next_legal_positions;
+        double probability_of_being_in_this_place = pacman_probabilities[cell];
 
-        for(std::vector< std::pair<int, int> >::reverse_iterator it = legal_positions.rbegin(); it != legal_positions.rend(); ++it)
-        {
-            if ( distances.find(*it) == distances.end() )
-            {
-                distances[*it] = current_distance;
-                done = false;
-
-                std::vector< std::pair<int, int> > temp_legal_positions = getLegalNextPositions(it->first, it->second);
-                next_legal_positions.reserve(next_legal_positions.size() + temp_legal_positions.size());
-                next_legal_positions.insert(next_legal_positions.end(), temp_legal_positions.begin(), temp_legal_positions.end());
-            }
-        }
+        if (probability_of_being_in_this_place == 0)
+            continue;
 
-        legal_positions = next_legal_positions;
+        for (int ghost_index = 0 ; ghost_index < num_ghosts_ ; ghost_index++)
+            probability += probability_of_being_in_this_place * ball_index.sum(ghosts_poses_map_[ghost_index].data(), cell);
     }
-    
-    return distances;
+
+    return probability;
 }
 
 void BayesianGameState::precalculateAllDistances()
 {
     ROS_DEBUG_STREAM("Pre-calculating all distances");
 
-    for (int i = 0 ; i < width_ ; i++)
+    open_cells_ = std::vector<bool> (width_ * height_, false);
+    for (int j = 0 ; j < height_ ; j++)
     {
-        for (int j = 0 ; j < height_ ; j++)
-        {
-            if( map_[j][i] != WALL )
-            {
-                precalculated_distances_[std::make_pair(i, j)] = calculateDistances(i, j);
-            }
-        }
+        for (int i = 0 ; i < width_ ; i++)
+            open_cells_[j * width_ + i] = map_[j][i] != WALL;
     }
 
+    distance_matrix_ = DistanceMatrix(width_, height_, open_cells_, DistanceMatrix::getDefaultCacheDirectory());
+
     ROS_DEBUG_STREAM("Pre-calculated all distances");
 }
 
-std::map< std::pair<int, int>, int > BayesianGameState::getDistances(int x, int y)
+const DistanceMatrix& BayesianGameState::getDistanceMatrix()
 {
-    std::map< std::pair<int, int>, int > distances = precalculated_distances_[std::make_pair(x, y)];
-    
-    return distances;
+    return distance_matrix_;
 }
 
-float BayesianGameState::getMaxFoodProbability()
+const BallIndex& BayesianGameState::getBallIndex(int n)
 {
-    double max_probability = -util::INFINITE;
+    if (n >= (int) ball_indexes_.size())
+        ball_indexes_.resize(n + 1);
 
-    for (int i = 0 ; i < width_ ; i++)
-    {
-        for (int j = 0 ; j < height_ ; j++)
-        {
-            double probability = this->foods_map_[j][i];
-            if (probability > max_probability)
-            {
-                max_probability = probability;
-            }
-        }
-    }
+    if (ball_indexes_[n].isEmpty())
+        ball_indexes_[n] = BallIndex(distance_matrix_, open_cells_, n);
 
-    return max_probability;
+    return ball_indexes_[n];
 }
 
-geometry_msgs::Pose BayesianGameState::getMostProbablePacmanPose()
+StepContext<BayesianGameState>& BayesianGameState::getStepContext()
 {
-    geometry_msgs::Pose probable_pose;
-
-    int probable_x = -1;
-    int probable_y = -1;
-    double max_probability = -util::INFINITE;
+    step_context_.update(this);
+    return step_context_;
+}
 
-    for (int i = 0 ; i < width_ ; i++)
-    {
-        for (int j = 0 ; j < height_ ; j++)
-        {
-            double probability = this->pacman_pose_map_[j][i];
-            if (probability > max_probability)
-            {
-                probable_x = i;
-                probable_y = j;
+float BayesianGameState::getMaxFoodProbability()
+{
+    return foods_map_.max();
+}
 
-                max_probability = probability;
-            }
-        }
-    }
+geometry_msgs::Pose BayesianGameState::getMostProbablePacmanPose()
+{
+    int cell = pacman_pose_map_.argmax();
 
-    probable_pose.position.x = probable_x;
-    probable_pose.position.y = probable_y;
+    geometry_msgs::Pose probable_pose;
+    probable_pose.position.x = cell % width_;
+    probable_pose.position.y = cell / width_;
 
     return probable_pose;
 }
 
 geometry_msgs::Pose BayesianGameState::getMostProbableGhostPose(int ghost_index)
 {
-    geometry_msgs::Pose probable_pose;
+    int cell = ghosts_poses_map_[ghost_index].argmax();
 
-    int probable_x = -1;
-    int probable_y = -1;
-    double max_probability = -util::INFINITE;
-
-    for (int i = 0 ; i < width_ ; i++)
-    {
-        for (int j = 0 ; j < height_ ; j++)
-        {
-            double probability = this->ghosts_poses_map_[ghost_index][j][i];
-            if (probability > max_probability)
-            {
-                probable_x = i;
-                probable_y = j;
-
-                max_probability = probability;
-            }
-        }
-    }
-
-    probable_pose.position.x = probable_x;
-    probable_pose.position.y = probable_y;
+    geometry_msgs::Pose probable_pose;
+    probable_pose.position.x = cell % width_;
+    probable_pose.position.y = cell / width_;
 
     return probable_pose;
 }
@@ -1,5 +1,6 @@
 #include "bayesian_q_learning/bayesian_q_learning.h"
 #include "pacman_abstract_classes/util_functions.h"
+#include "pacman_abstract_classes/random_stream.h"
 #include "bayesian_q_learning/bayesian_behavior_agent.h"
 
 #include <iostream>
@@ -34,7 +35,17 @@ void BayesianQLearning::saveTempFeatures(int behavior)
     behavior_ = behavior;
 }
 
-std::vector<double> BayesianQLearning::getFeatures(BayesianGameState *game_state, int behavior)
+const std::vector<double>& BayesianQLearning::getFeatures(BayesianGameState *game_state, int behavior)
+{
+    StepContext<BayesianGameState>& step_context = game_state->getStepContext();
+
+    if (!step_context.hasFeatures())
+        step_context.setFeatures(calculateFeatures(game_state));
+
+    return step_context.getFeatures();
+}
+
+std::vector<double> BayesianQLearning::calculateFeatures(BayesianGameState *game_state)
 {
     std::vector<double> features;
 
@@ -109,9 +120,10 @@ int BayesianQLearning::getBehavior(BayesianGameState *game_state)
 
 int BayesianQLearning::getTrainingBehavior(BayesianGameState *game_state)
 {
-    double random = rand() / (float) RAND_MAX;
+    RandomStream& random_stream = RandomStream::getThreadStream();
+    double random = random_stream.getUniform();
     if (random < exploration_rate_) {
-        int behavior = rand() % NUM_BEHAVIORS;
+        int behavior = random_stream.getInt(NUM_BEHAVIORS);
 
         old_q_value_ = getQValue(game_state, behavior);
         saveTempFeatures(behavior);
@@ -2,12 +2,15 @@
 
 #include "pacman_msgs/PacmanAction.h"
 #include "pacman_msgs/StartGame.h"
+#include "pacman_abstract_classes/random_stream.h"
 
 #include <mcheck.h>
 
 int NUMBER_OF_GAMES = 10005;
 int NUMBER_OF_TRAININGS = 5005;
 bool is_training = true;
+// seed of the match, 0 takes it from the clock
+uint64_t RANDOM_SEED = 0;
 
 int main(int argc, char **argv)
 {
@@ -16,7 +19,9 @@ int main(int argc, char **argv)
     ros::NodeHandle n;
     ros::Rate loop_rate(1);
 
-    srand (time(NULL)); // start random fucntions
+    if (!RANDOM_SEED)
+        RANDOM_SEED = time(NULL);
+    RandomStream::setMatchSeed(RANDOM_SEED);
 
     ros::Publisher chatter_pub = n.advertise<pacman_msgs::PacmanAction>("/random_topic", 1000);
 
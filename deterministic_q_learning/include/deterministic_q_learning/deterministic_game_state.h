@@ -2,6 +2,7 @@
 #define BAYESIAN_GAME_STATE_H
 
 #include "q_learning_pacman/game_state.h"
+#include "pacman_abstract_classes/distance_matrix.h"
 
 #include "geometry_msgs/Pose.h"
 #include "pacman_msgs/AgentPoseService.h"
@@ -23,8 +24,7 @@ class DeterministicGameState : public GameState
     ros::ServiceServer ghost_distance_observer_service_;
 
     // precalculate all real distances in map
-    std::map< std::pair<int, int>, std::map< std::pair<int, int>, int > > precalculated_distances_;
-    std::map< std::pair<int, int>, int > calculateDistances(int x, int y);
+    DistanceMatrix distance_matrix_;
     void precalculateAllDistances();
 
   public:
@@ -50,7 +50,7 @@ class DeterministicGameState : public GameState
     bool dies(pacman_msgs::PacmanAction action);
 
     // usefull functions
-    std::map< std::pair<int, int>, int > getDistances(int x, int y);
+    const DistanceMatrix& getDistanceMatrix();
 };
 
 #endif // BAYESIAN_GAME_STATE_H
\ No newline at end of file
@@ -9,10 +9,13 @@
 #include "deterministic_q_learning/deterministic_game_state.h"
 #include "deterministic_q_learning/deterministic_behavior_agent.h"
 #include "deterministic_q_learning/deterministic_q_learning.h"
+#include "pacman_abstract_classes/random_stream.h"
 
 int NUMBER_OF_GAMES = 10005;
 int NUMBER_OF_TRAININGS = 5005;
 bool is_training = true;
+// seed of the first match, the following ones add the number of matches played, 0 takes it from the clock
+uint64_t RANDOM_SEED = 0;
 
 bool endGame(pacman_msgs::EndGame::Request &req, pacman_msgs::EndGame::Response &res, 
         ros::ServiceClient *start_game_client, DeterministicGameState **game_state)
@@ -41,6 +44,7 @@ bool endGame(pacman_msgs::EndGame::Request &req, pacman_msgs::EndGame::Response
             if(start_game.response.started)
             {
                 // new game started
+                RandomStream::setMatchSeed(RANDOM_SEED + game_count);
                 delete *game_state;
                 *game_state = new DeterministicGameState();
                 res.game_restarted = true;
@@ -101,7 +105,9 @@ int main(int argc, char **argv)
     ros::NodeHandle n;
     ros::Rate loop_rate(1);
 
-    srand (time(NULL)); // start random fucntions
+    if (!RANDOM_SEED)
+        RANDOM_SEED = time(NULL);
+    RandomStream::setMatchSeed(RANDOM_SEED);
     DeterministicGameState *game_state = new DeterministicGameState();
     DeterministicBehaviorAgent pacman;
     DeterministicQLearning *q_learning = new DeterministicQLearning;
@@ -58,7 +58,8 @@ pacman_msgs::PacmanAction DeterministicBehaviorAgent::getRunAction(Deterministic
     pacman_msgs::PacmanAction action;
 
     geometry_msgs::Pose pacman_pose = game_state->getPacmanPose();
-    std::map< std::pair<int, int>, int > distances = game_state->getDistances(pacman_pose.position.x, pacman_pose.position.y);
+    const DistanceMatrix& distance_matrix = game_state->getDistanceMatrix();
+    const uint16_t *distances = distance_matrix.getDistanceRow(pacman_pose.position.x, pacman_pose.position.y);
 
     int min_distance = util::MAX_DISTANCE;
 
@@ -66,7 +67,7 @@ pacman_msgs::PacmanAction DeterministicBehaviorAgent::getRunAction(Deterministic
     std::vector< geometry_msgs::Pose >::reverse_iterator closest_ghost;
     for(std::vector< geometry_msgs::Pose >::reverse_iterator it = ghosts_poses.rbegin(); it != ghosts_poses.rend(); ++it) {
         /* std::cout << *it; ... */
-        int distance = distances[std::make_pair(it->position.x, it->position.y)];
+        int distance = distance_matrix.distance(distances, it->position.x, it->position.y);
         if(distance != 0 && distance < min_distance)
         {
             closest_ghost = it;
@@ -77,15 +78,15 @@ pacman_msgs::PacmanAction DeterministicBehaviorAgent::getRunAction(Deterministic
     //game_state->printMap();
     //ROS_INFO_STREAM("x: " << closest_ghost->position.x << " y: " << closest_ghost->position.y );
 
-    distances = game_state->getDistances(closest_ghost->position.x, closest_ghost->position.y);
+    distances = distance_matrix.getDistanceRow(closest_ghost->position.x, closest_ghost->position.y);
     std::vector< pacman_msgs::PacmanAction > actions = game_state->getLegalActions(pacman_pose.position.x, pacman_pose.position.y);
     std::vector< std::pair<int, int> > next_positions = game_state->getLegalNextPositions(pacman_pose.position.x, pacman_pose.position.y);
 
     int action_iterator = 0;
     for(int i = next_positions.size() - 1; i != -1; i--)
     {
-        //ROS_INFO_STREAM("- distance " << (short) actions[i].action << " : " << distances[ next_positions[i] ] );
-        if ( distances[ next_positions[i] ] > min_distance )
+        //ROS_INFO_STREAM("- distance " << (short) actions[i].action << " : " << distance_matrix.distance(distances, next_positions[i].first, next_positions[i].second) );
+        if ( distance_matrix.distance(distances, next_positions[i].first, next_positions[i].second) > min_distance )
         {
             action_iterator = i;
             break;
@@ -105,7 +106,8 @@ pacman_msgs::PacmanAction DeterministicBehaviorAgent::getEatAction(Deterministic
     pacman_msgs::PacmanAction action;
 
     geometry_msgs::Pose pacman_pose = game_state->getPacmanPose();
-    std::map< std::pair<int, int>, int > distances = game_state->getDistances(pacman_pose.position.x, pacman_pose.position.y);
+    const DistanceMatrix& distance_matrix = game_state->getDistanceMatrix();
+    const uint16_t *distances = distance_matrix.getDistanceRow(pacman_pose.position.x, pacman_pose.position.y);
 
     int width = game_state->getWidth();
     int height = game_state->getHeight();
@@ -119,7 +121,7 @@ pacman_msgs::PacmanAction DeterministicBehaviorAgent::getEatAction(Deterministic
         {
             if( game_state->getMapElement(i, j) == DeterministicGameState::FOOD)
             {
-                int distance = distances[std::make_pair(i, j)];
+                int distance = distance_matrix.distance(distances, i, j);
                 if(distance < min_distance)
                 {
                     food_x = i;
@@ -130,14 +132,14 @@ pacman_msgs::PacmanAction DeterministicBehaviorAgent::getEatAction(Deterministic
         }
     }
 
-    distances = game_state->getDistances(food_x, food_y);
+    distances = distance_matrix.getDistanceRow(food_x, food_y);
     std::vector< pacman_msgs::PacmanAction > actions = game_state->getLegalActions(pacman_pose.position.x, pacman_pose.position.y);
     std::vector< std::pair<int, int> > next_positions = game_state->getLegalNextPositions(pacman_pose.position.x, pacman_pose.position.y);
 
     int action_iterator = 0;
     for(int i = next_positions.size() - 1; i != -1; i--)
     {
-        if ( distances[ next_positions[i] ] < min_distance )
+        if ( distance_matrix.distance(distances, next_positions[i].first, next_positions[i].second) < min_distance )
         {
             action_iterator = i;
             break;
@@ -1,5 +1,6 @@
 #include "deterministic_q_learning/deterministic_q_learning.h"
 #include "pacman_abstract_classes/util_functions.h"
+#include "pacman_abstract_classes/random_stream.h"
 
 #include "deterministic_q_learning/deterministic_behavior_agent.h"
 
@@ -106,9 +107,10 @@ int DeterministicQLearning::getBehavior(DeterministicGameState *game_state)
 
 int DeterministicQLearning::getTrainingBehavior(DeterministicGameState *game_state)
 {
-    double random = rand() / (float) RAND_MAX;
+    RandomStream& random_stream = RandomStream::getThreadStream();
+    double random = random_stream.getUniform();
     if (random < exploration_rate_) {
-        int behavior = rand() % NUM_BEHAVIORS;
+        int behavior = random_stream.getInt(NUM_BEHAVIORS);
 
         old_q_value_ = getQValue(game_state, behavior);
         saveTempFeatures(behavior);
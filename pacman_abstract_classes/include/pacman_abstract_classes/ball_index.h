@@ -0,0 +1,44 @@
+#ifndef BALL_INDEX_H
+#define BALL_INDEX_H
+
+#include <vector>
+
+#include "pacman_abstract_classes/distance_matrix.h"
+#include "pacman_abstract_classes/probability_grid.h"
+
+/**
+ * Class that lists, for every open cell of a layout, the open cells at maze distance smaller
+ * than a radius, stored contiguously (cells of cell k are at [getBegin(k), getEnd(k)) ).
+ * Membership matches the old bounding box scan, so unreachable open cells inside the box
+ * (distance 0 in the matrix) are part of the ball, and wall cells have empty balls.
+ *
+ * @author Tiago Pimentel Martins da Silva
+ */
+class BallIndex
+{
+  protected:
+    int width_;
+    int height_;
+    int radius_;
+    std::vector<int> offsets_;
+    std::vector<int> cells_;
+
+  public:
+    BallIndex();
+    // open_cells[y * width + x] is true for every cell that is not a wall
+    BallIndex(const DistanceMatrix& distance_matrix, const std::vector<bool>& open_cells, int radius);
+    ~BallIndex();
+
+    int getRadius() const;
+    bool isEmpty() const;
+
+    int getBegin(int cell) const;
+    int getEnd(int cell) const;
+    int getCell(int k) const;
+
+    // sum of values (a row major grid) over the ball around cell
+    double sum(const float *values, int cell) const;
+    double sum(const ProbabilityGrid& grid, int cell) const;
+};
+
+#endif // BALL_INDEX_H
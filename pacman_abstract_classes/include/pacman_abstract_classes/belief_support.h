@@ -0,0 +1,45 @@
+#ifndef BELIEF_SUPPORT_H
+#define BELIEF_SUPPORT_H
+
+#include <vector>
+
+#include "pacman_abstract_classes/probability_grid.h"
+
+/**
+ * Class that keeps the list of grid cells where a belief may have non zero probability,
+ * so belief updates can iterate only over them instead of sweeping the whole map.
+ * 
+ * @author Tiago Pimentel Martins da Silva
+ */
+class BeliefSupport
+{
+  protected:
+    int width_;
+    int height_;
+    std::vector<int> cells_;
+    std::vector<bool> is_active_;
+
+  public:
+    BeliefSupport();
+    BeliefSupport(int width, int height);
+    ~BeliefSupport();
+
+    void clear();
+    void add(int x, int y);
+    void addCell(int cell);
+    bool contains(int x, int y);
+    void rebuild(const ProbabilityGrid& belief_map);
+    void removeEmptyCells(const ProbabilityGrid& belief_map);
+    // zeroes and removes the cells with less than threshold times the total probability of the belief, and scales
+    // the rest so the belief keeps its total. A belief spread too thin to keep any cell is left whole.
+    // Returns the fraction of the total that was pruned
+    double prune(ProbabilityGrid& belief_map, float threshold);
+    void swap(BeliefSupport& other);
+
+    int size();
+    int getCell(int position);
+    int getX(int position);
+    int getY(int position);
+};
+
+#endif // BELIEF_SUPPORT_H
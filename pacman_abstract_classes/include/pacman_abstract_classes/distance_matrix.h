@@ -0,0 +1,62 @@
+#ifndef DISTANCE_MATRIX_H
+#define DISTANCE_MATRIX_H
+
+#include <vector>
+#include <string>
+#include <stdint.h>
+
+#include <boost/shared_ptr.hpp>
+
+/**
+ * Class that holds the maze distance between every pair of cells of a layout in a dense matrix.
+ * Cells are indexed as y * width + x. Walls, unreachable cells and origins outside the map
+ * are at distance 0, the same value the old per cell distance maps returned for missing keys.
+ * With a cache directory the matrix is memory mapped from a file named after the layout hash,
+ * and only calculated (one breadth first search per cell, split across all cores) on a miss.
+ *
+ * @author Tiago Pimentel Martins da Silva
+ */
+class DistanceMatrix
+{
+  protected:
+    int width_;
+    int height_;
+    int num_cells_;
+    uint64_t layout_hash_;
+    // owns either a heap array or a file mapping, shared by copies of the matrix
+    boost::shared_ptr<const void> storage_;
+    const uint16_t *distances_;
+    std::vector<uint16_t> unreachable_row_;
+
+    void calculate(const std::vector<bool>& open_cells);
+    void calculateDistances(int first_origin, int origin_step, const std::vector<bool>& open_cells, uint16_t *distances);
+    bool loadCache(const std::string& cache_file);
+    void writeCache(const std::string& cache_file);
+
+  public:
+    DistanceMatrix();
+    // open_cells[y * width + x] is true for every cell that is not a wall, empty cache_directory disables caching
+    DistanceMatrix(int width, int height, const std::vector<bool>& open_cells, const std::string& cache_directory = "");
+    ~DistanceMatrix();
+
+    static uint64_t hashLayout(int width, int height, const std::vector<bool>& open_cells);
+    // $ROS_HOME/pacman_distances, or ~/.ros/pacman_distances
+    static std::string getDefaultCacheDirectory();
+
+    int getWidth() const;
+    int getHeight() const;
+    int getNumberOfCells() const;
+    uint64_t getLayoutHash() const;
+    // -1 if (x, y) is outside the map
+    int getCell(int x, int y) const;
+
+    // distances from cell to all cells, valid while the matrix or one of its copies lives,
+    // a row of zeros if the cell is outside the map and NULL if the matrix is empty
+    const uint16_t* getDistanceRow(int cell) const;
+    const uint16_t* getDistanceRow(int x, int y) const;
+    int distance(int from_cell, int to_cell) const;
+    // distance_row[getCell(x, y)], 0 if (x, y) is outside the map
+    int distance(const uint16_t* distance_row, int x, int y) const;
+};
+
+#endif // DISTANCE_MATRIX_H
@@ -0,0 +1,53 @@
+#ifndef FOOD_BELIEF_H
+#define FOOD_BELIEF_H
+
+#include <vector>
+#include <stdint.h>
+
+#include "pacman_abstract_classes/probability_grid.h"
+
+/**
+ * Class that indexes a food probability grid by certainty. Cells where food is certainly present
+ * are bits of a bitset, cells with a fractional probability are kept in a short list, and every
+ * other cell is known to have no food. Only the cells pacman may reach ever become uncertain, so
+ * max and closest food queries visit set bits and that list instead of the whole grid.
+ * 
+ * @author Tiago Pimentel Martins da Silva
+ */
+class FoodBelief
+{
+  protected:
+    int width_;
+    int height_;
+    std::vector<uint64_t> present_bits_;
+    int num_present_cells_;
+    std::vector<int> uncertain_cells_;
+    std::vector<float> uncertain_probabilities_;
+    // position of each cell in uncertain_cells_, -1 if it is not there
+    std::vector<int> uncertain_positions_;
+
+    bool isPresent(int cell) const;
+    void setPresent(int cell, bool is_present);
+    void removeUncertain(int cell);
+    // true if cell is closer than the current closest, ties going to the lowest x and then the lowest y
+    bool isCloser(int cell, int distance, int closest_cell, int min_distance) const;
+
+  public:
+    FoodBelief();
+    FoodBelief(int width, int height);
+    ~FoodBelief();
+
+    void rebuild(const ProbabilityGrid& food_map);
+    void set(int cell, float probability);
+    float get(int cell) const;
+
+    int getNumberOfPresentCells() const;
+    int getNumberOfUncertainCells() const;
+    // same as the max of the grid
+    float getMaxProbability() const;
+    // closest cell with at least threshold probability and sets min_distance to its distance, in the same
+    // order as a column major sweep; -1 (and max_distance) if no such cell is closer than max_distance
+    int findClosestCell(float threshold, const uint16_t *distances, int max_distance, int& min_distance) const;
+};
+
+#endif // FOOD_BELIEF_H
@@ -0,0 +1,56 @@
+#ifndef LIKELIHOOD_TABLE_H
+#define LIKELIHOOD_TABLE_H
+
+#include <vector>
+#include <map>
+
+#include <boost/thread/mutex.hpp>
+
+/**
+ * Class that holds the per axis weights of the separable gaussian measurement model for every
+ * integer offset in [-max_offset, max_offset], so the likelihood of an integer offset is two
+ * lookups and a product instead of an exponential. Tables are immutable once built and shared
+ * by every user of the same standard deviation and range.
+ * 
+ * @author Tiago Pimentel Martins da Silva
+ */
+class LikelihoodTable
+{
+  protected:
+    double standard_deviation_;
+    int max_offset_;
+    // weights_[offset + max_offset_] = e^( - offset ^ 2 / ( 2 * std_deviation ^ 2 ) )
+    std::vector<double> weights_;
+    // -1 for offsets outside the table
+    int getWeightIndex(int offset) const;
+
+    // exponent (relative to the closest position) after which axis weights are left at 0
+    static double MAX_WINDOW_EXPONENT;
+
+    static boost::mutex tables_mutex_;
+    static std::map< std::pair<double, int>, LikelihoodTable > tables_;
+
+  public:
+    LikelihoodTable();
+    LikelihoodTable(double standard_deviation, int max_offset);
+    ~LikelihoodTable();
+
+    // shared table for a standard deviation, the reference stays valid for the whole program
+    static const LikelihoodTable& getTable(double standard_deviation, int max_offset);
+    // true when 3 standard deviations are under half a cell, so only the closest cell to a measurement
+    // has a likelihood that survives in a float belief
+    static bool isNearlyDeterministic(double standard_deviation);
+
+    double getStandardDeviation() const;
+    int getMaxOffset() const;
+
+    // weight of an offset along one axis, 0 outside the table
+    double getWeight(int offset) const;
+    // e^( - ( x_offset ^ 2 + y_offset ^ 2 ) / ( 2 * std_deviation ^ 2 ) )
+    double getLikelihood(int x_offset, int y_offset) const;
+    // weights[position] is the weight of ( measurement - position ) for every position in [0, size),
+    // positions outside the window around the closest one are 0
+    void getAxisWeights(double measurement, int size, std::vector<double>& weights) const;
+};
+
+#endif // LIKELIHOOD_TABLE_H
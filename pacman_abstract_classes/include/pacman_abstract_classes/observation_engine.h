@@ -0,0 +1,66 @@
+#ifndef OBSERVATION_ENGINE_H
+#define OBSERVATION_ENGINE_H
+
+#include <vector>
+
+#include "pacman_abstract_classes/probability_grid.h"
+#include "pacman_abstract_classes/task_scheduler.h"
+
+/**
+ * Class that computes the likelihood of a relative distance measurement for every grid cell.
+ * The gaussian measurement model is separable, so it is kept as two truncated per axis kernels
+ * over integer offsets and cross-correlated with the belief of the agent the offset is relative to.
+ * 
+ * @author Tiago Pimentel Martins da Silva
+ */
+class ObservationEngine
+{
+  protected:
+    double standard_deviation_;
+
+    // exponent (relative to the closest offset) after which kernel weights are dropped
+    static double MAX_KERNEL_EXPONENT;
+    // grids with fewer cells per band than this are correlated on a single thread
+    static int MIN_BAND_CELLS;
+
+    std::vector<double> x_weights_;
+    std::vector<double> y_weights_;
+    int first_x_offset_;
+    int first_y_offset_;
+    TaskScheduler *task_scheduler_;
+
+    int getAxisKernel(double measurement, int max_offset, std::vector<double>& weights);
+
+    template <class Grid>
+    void correlate(const Grid& origin_map, double measurement_x_dist, double measurement_y_dist,
+                                int width, int height, Grid& row_likelihood, Grid& likelihood_map);
+    template <class Grid>
+    void correlateRows(const Grid *origin_map, int width, Grid *row_likelihood,
+                                std::vector<char> *row_has_mass, int first_row, int end_row);
+    template <class Grid>
+    void correlateColumns(int width, int height, const Grid *row_likelihood,
+                                const std::vector<char> *row_has_mass, Grid *likelihood_map, int first_row, int end_row);
+
+  public:
+    ObservationEngine(double standard_deviation);
+    ~ObservationEngine();
+
+    double getStandardDeviation();
+    // true when a measurement only leaves the closest integer offset, see LikelihoodTable
+    bool isNearlyDeterministic();
+    // splits the likelihood of large grids in bands of rows run by task_scheduler, NULL runs them in one sweep
+    void setTaskScheduler(TaskScheduler *task_scheduler);
+
+    // prepares the kernels for a measurement in a width x height map
+    void setMeasurement(double measurement_x_dist, double measurement_y_dist, int width, int height);
+    // likelihood (up to a constant) of the current measurement given the real offset
+    double getOffsetLikelihood(int x_dist, int y_dist);
+
+    // likelihood[y][x] is proportional to sum over origins of origin_map[oy][ox] * p(z | x - ox, y - oy)
+    std::vector< std::vector<float> > getRelativeMeasurementLikelihood(const std::vector< std::vector<float> >& origin_map,
+                                double measurement_x_dist, double measurement_y_dist);
+    ProbabilityGrid getRelativeMeasurementLikelihood(const ProbabilityGrid& origin_map,
+                                double measurement_x_dist, double measurement_y_dist);
+};
+
+#endif // OBSERVATION_ENGINE_H
@@ -0,0 +1,137 @@
+#ifndef PROBABILITY_GRID_H
+#define PROBABILITY_GRID_H
+
+#include <vector>
+#include <stdint.h>
+#include <string.h>
+#include <boost/shared_ptr.hpp>
+
+/**
+ * Class that stores a probability for each cell of the map in one contiguous, aligned, row major
+ * buffer (cell x, y is at y * width + x). Grids of the same layout can share a mask of open cells
+ * (1 for open, 0 for wall). Its whole grid operations are simple loops over the buffer, so the
+ * compiler can vectorize them.
+ * Cells are floats unless the grid is built with a 16 bit storage, which halves its memory and the
+ * bytes moved by copies. FIXED_POINT keeps values in [0, 1] with an absolute error of at most 2^-17
+ * and 0 and 1 exact, which suits the food maps. BFLOAT16 keeps the float exponent with a relative
+ * error of at most 2^-8, which suits agent beliefs spread over many small probabilities. 16 bit
+ * grids are read and written through get and set, and their operations accumulate in float.
+ * 
+ * @author Tiago Pimentel Martins da Silva
+ */
+class ProbabilityGrid
+{
+  public:
+    typedef enum {FLOAT, FIXED_POINT, BFLOAT16} Storage;
+
+  protected:
+    int width_;
+    int height_;
+    int size_;
+    Storage storage_;
+    // cells of a FLOAT grid, NULL otherwise
+    float *data_;
+    // cells of a 16 bit grid, NULL otherwise
+    uint16_t *quantized_data_;
+    boost::shared_ptr< const std::vector<float> > open_cells_mask_;
+
+    static int ALIGNMENT;
+
+    void allocate(int size);
+    // other has the same size and storage
+    void copyCells(const ProbabilityGrid& other);
+    int getCellBytes() const;
+
+    static uint16_t encode(float value, Storage storage);
+    static float decode(uint16_t value, Storage storage);
+
+  public:
+    ProbabilityGrid();
+    ProbabilityGrid(int width, int height, float value = 0, Storage storage = FLOAT);
+    ProbabilityGrid(const ProbabilityGrid& other);
+    // copy of other with its cells converted to storage
+    ProbabilityGrid(const ProbabilityGrid& other, Storage storage);
+    ProbabilityGrid& operator=(const ProbabilityGrid& other);
+    ~ProbabilityGrid();
+
+    int getWidth() const;
+    int getHeight() const;
+    int getSize() const;
+    Storage getStorage() const;
+    // bytes held by the cells, which is what a copy moves
+    int getMemorySize() const;
+    // converts every cell in place, the values round as encode does
+    void setStorage(Storage storage);
+
+    // grid[y][x], FLOAT grids only
+    float *operator[](int y);
+    const float *operator[](int y) const;
+    float *data();
+    const float *data() const;
+
+    // any storage, cell is y * width + x
+    float get(int cell) const;
+    void set(int cell, float value);
+
+    void setOpenCellsMask(const boost::shared_ptr< const std::vector<float> >& open_cells_mask);
+    const boost::shared_ptr< const std::vector<float> >& getOpenCellsMask() const;
+
+    void swap(ProbabilityGrid& other);
+    void fill(float value);
+    void fillOpenCells(float value);
+    void applyOpenCellsMask();
+    void multiply(const ProbabilityGrid& other);
+    void scale(float factor);
+    double sum() const;
+    bool normalize();
+    float max() const;
+    int argmax() const;
+    int countAtLeast(float threshold) const;
+};
+
+inline uint16_t ProbabilityGrid::encode(float value, Storage storage)
+{
+    if (storage == FIXED_POINT)
+    {
+        if (value <= 0)
+            return 0;
+        if (value >= 1)
+            return 65535;
+        return (uint16_t) (value * 65535.0 + 0.5);
+    }
+
+    // upper half of the float, rounded to nearest even on the dropped half
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    bits += 0x7FFF + ( (bits >> 16) & 1 );
+    return (uint16_t) (bits >> 16);
+}
+
+inline float ProbabilityGrid::decode(uint16_t value, Storage storage)
+{
+    if (storage == FIXED_POINT)
+        return value / 65535.0f;
+
+    uint32_t bits = ( (uint32_t) value ) << 16;
+    float decoded;
+    memcpy(&decoded, &bits, sizeof(decoded));
+    return decoded;
+}
+
+inline float ProbabilityGrid::get(int cell) const
+{
+    if (storage_ == FLOAT)
+        return data_[cell];
+
+    return decode(quantized_data_[cell], storage_);
+}
+
+inline void ProbabilityGrid::set(int cell, float value)
+{
+    if (storage_ == FLOAT)
+        data_[cell] = value;
+    else
+        quantized_data_[cell] = encode(value, storage_);
+}
+
+#endif // PROBABILITY_GRID_H
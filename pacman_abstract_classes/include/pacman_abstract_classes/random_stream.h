@@ -0,0 +1,67 @@
+#ifndef RANDOM_STREAM_H
+#define RANDOM_STREAM_H
+
+#include <stdint.h>
+
+#include <boost/atomic.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/tss.hpp>
+
+/**
+ * Class that generates random numbers with a PCG32 generator. A stream is a seed and a stream
+ * index, and streams with the same seed and different indexes are independent, so each thread
+ * and each block of particles draws from its own stream without any lock. Every stream of a
+ * match derives from the match seed, which makes a match reproducible from that seed alone.
+ *
+ * @author Tiago Pimentel Martins da Silva
+ */
+class RandomStream
+{
+  protected:
+    uint64_t state_;
+    uint64_t increment_;
+    // state after i + 1 steps is multipliers_[i] * state + increments_[i], for the bulk generation lanes
+    uint64_t lane_multipliers_[4];
+    uint64_t lane_increments_[4];
+
+    static uint32_t getOutput(uint64_t state);
+
+    static boost::mutex match_seed_mutex_;
+    static bool is_match_seed_set_;
+    static uint64_t match_seed_;
+    // changes with the match seed, so thread streams know when to reseed. Read without the mutex, so
+    // a thread whose stream is current never locks
+    static boost::atomic<int> match_seed_version_;
+    static uint64_t num_thread_streams_;
+    // takes the match seed from the clock if it was never set, match_seed_mutex_ must be held
+    static void initializeMatchSeed();
+
+    // a stream and the match seed version it was seeded with
+    struct ThreadStream;
+    static boost::thread_specific_ptr<ThreadStream> thread_stream_;
+
+  public:
+    RandomStream();
+    RandomStream(uint64_t seed, uint64_t stream_index);
+
+    void seed(uint64_t seed, uint64_t stream_index);
+
+    uint32_t next();
+    // uniform in [0, 1)
+    double getUniform();
+    // uniform in [0, n)
+    int getInt(int n);
+    // same numbers as num_uniforms calls to getUniform, drawn four independent steps at a time
+    void fillUniforms(double *uniforms, int num_uniforms);
+
+    // a match seed that was never set is taken from the clock
+    static void setMatchSeed(uint64_t seed);
+    static uint64_t getMatchSeed();
+    // stream of the calling thread, threads are numbered in the order they first ask for one. Only locks
+    // the first time and after the match seed changes, to seed the stream
+    static RandomStream& getThreadStream();
+    // stream of a block of work of the match, the same for a given match seed whichever thread runs it
+    static RandomStream getBlockStream(uint64_t block);
+};
+
+#endif // RANDOM_STREAM_H
@@ -0,0 +1,74 @@
+#ifndef TASK_SCHEDULER_H
+#define TASK_SCHEDULER_H
+
+#include <vector>
+#include <deque>
+
+#include <boost/function.hpp>
+#include <boost/thread.hpp>
+#include <boost/noncopyable.hpp>
+
+/**
+ * Class that runs graphs of tasks on a pool of threads. Each thread has its own deque: it pops
+ * the tasks it released itself from the back and, when it runs out, steals from the front of
+ * the others. A thread waiting for a run or a parallel for helps with queued tasks meanwhile,
+ * so they can be nested. Tasks are coarse (a belief sweep or a band of rows), so a single lock
+ * guards the deques.
+ *
+ * @author Tiago Pimentel Martins da Silva
+ */
+class TaskScheduler : private boost::noncopyable
+{
+  public:
+    typedef boost::function<void ()> Task;
+    typedef boost::function<void (int, int)> RangeTask;
+
+    // 0 threads uses one per core, 1 runs every task on the calling thread
+    TaskScheduler(int num_threads = 0);
+    ~TaskScheduler();
+
+    int getNumberOfThreads() const;
+
+    // adds a task to the next run, which starts only after its dependencies (ids returned here) finish
+    int addTask(const Task& task);
+    int addTask(const Task& task, int dependency);
+    int addTask(const Task& task, const std::vector<int>& dependencies);
+    // runs all added tasks and returns when they have finished
+    void run();
+
+    // calls range_task(band_begin, band_end) for bands of [begin, end) with at least min_band_size elements
+    void parallelFor(int begin, int end, int min_band_size, const RangeTask& range_task);
+
+  protected:
+    struct TaskNode
+    {
+        Task task;
+        std::vector<int> successors;
+        int remaining_dependencies;
+        int group;
+    };
+
+    int num_threads_;
+    boost::thread_group workers_;
+    boost::thread_specific_ptr<int> worker_index_;
+    boost::mutex mutex_;
+    boost::condition_variable condition_;
+    bool is_stopping_;
+
+    std::vector<TaskNode> nodes_;
+    std::vector<int> unscheduled_tasks_;
+    // one deque per thread, index 0 belongs to threads outside the pool
+    std::vector< std::deque<int> > queues_;
+    // unfinished tasks of each run or parallel for still being waited on
+    std::vector<int> group_pending_;
+    int active_groups_;
+
+    int getWorkerIndex();
+    int newGroup(int num_tasks);
+    bool popTask(int worker_index, int& task_index);
+    void executeTask(boost::unique_lock<boost::mutex>& lock, int worker_index, int task_index);
+    void waitForGroup(boost::unique_lock<boost::mutex>& lock, int worker_index, int group);
+    void workerLoop(int worker_index);
+};
+
+#endif // TASK_SCHEDULER_H
@@ -0,0 +1,103 @@
+#include "pacman_abstract_classes/ball_index.h"
+
+BallIndex::BallIndex()
+{
+    width_ = 0;
+    height_ = 0;
+    radius_ = 0;
+}
+
+BallIndex::BallIndex(const DistanceMatrix& distance_matrix, const std::vector<bool>& open_cells, int radius)
+{
+    width_ = distance_matrix.getWidth();
+    height_ = distance_matrix.getHeight();
+    radius_ = radius;
+
+    int num_cells = width_ * height_;
+    offsets_ = std::vector<int> (num_cells + 1, 0);
+
+    for (int cell = 0 ; cell < num_cells ; cell++)
+    {
+        offsets_[cell] = cells_.size();
+        if (!open_cells[cell])
+            continue;
+
+        int i = cell % width_;
+        int j = cell / width_;
+        const uint16_t *distances = distance_matrix.getDistanceRow(cell);
+
+        // cells further than radius - 1 in either axis can not be closer than radius
+        int min_i = (i - radius > 0) ? (i - radius) : 0;
+        int min_j = (j - radius > 0) ? (j - radius) : 0;
+
+        for (int ball_i = min_i ; ( (ball_i - i) < radius ) && ( ball_i < width_ ) ; ball_i++)
+        {
+            for (int ball_j = min_j ; ( (ball_j - j) < radius ) && ( ball_j < height_ ) ; ball_j++)
+            {
+                int ball_cell = ball_j * width_ + ball_i;
+                if (distances[ball_cell] < radius && open_cells[ball_cell])
+                    cells_.push_back(ball_cell);
+            }
+        }
+    }
+    offsets_[num_cells] = cells_.size();
+}
+
+BallIndex::~BallIndex()
+{
+    offsets_.clear();
+    cells_.clear();
+}
+
+int BallIndex::getRadius() const
+{
+    return radius_;
+}
+
+bool BallIndex::isEmpty() const
+{
+    return offsets_.empty();
+}
+
+int BallIndex::getBegin(int cell) const
+{
+    return offsets_[cell];
+}
+
+int BallIndex::getEnd(int cell) const
+{
+    return offsets_[cell + 1];
+}
+
+int BallIndex::getCell(int k) const
+{
+    return cells_[k];
+}
+
+double BallIndex::sum(const float *values, int cell) const
+{
+    int end = offsets_[cell + 1];
+
+    double total = 0;
+    if (offsets_[cell] == end)
+        return total;
+
+    const int *ball_cells = &cells_[0];
+    for (int k = offsets_[cell] ; k < end ; k++)
+        total += values[ball_cells[k]];
+
+    return total;
+}
+
+double BallIndex::sum(const ProbabilityGrid& grid, int cell) const
+{
+    if (grid.getStorage() == ProbabilityGrid::FLOAT)
+        return sum(grid.data(), cell);
+
+    double total = 0;
+    int end = offsets_[cell + 1];
+    for (int k = offsets_[cell] ; k < end ; k++)
+        total += grid.get(cells_[k]);
+
+    return total;
+}
@@ -0,0 +1,140 @@
+#include "pacman_abstract_classes/belief_support.h"
+
+#include <algorithm>
+
+BeliefSupport::BeliefSupport()
+{
+    width_ = 0;
+    height_ = 0;
+}
+
+BeliefSupport::BeliefSupport(int width, int height)
+{
+    width_ = width;
+    height_ = height;
+    is_active_ = std::vector<bool> (width * height, false);
+}
+
+BeliefSupport::~BeliefSupport()
+{
+    cells_.clear();
+    is_active_.clear();
+}
+
+void BeliefSupport::clear()
+{
+    for(std::vector<int>::reverse_iterator it = cells_.rbegin(); it != cells_.rend(); ++it)
+        is_active_[*it] = false;
+
+    cells_.clear();
+}
+
+void BeliefSupport::add(int x, int y)
+{
+    addCell(y * width_ + x);
+}
+
+void BeliefSupport::addCell(int cell)
+{
+    if (!is_active_[cell])
+    {
+        is_active_[cell] = true;
+        cells_.push_back(cell);
+    }
+}
+
+bool BeliefSupport::contains(int x, int y)
+{
+    return is_active_[y * width_ + x];
+}
+
+void BeliefSupport::rebuild(const ProbabilityGrid& belief_map)
+{
+    clear();
+
+    for (int cell = 0 ; cell < width_ * height_ ; cell++)
+    {
+        if (belief_map.get(cell) != 0)
+        {
+            is_active_[cell] = true;
+            cells_.push_back(cell);
+        }
+    }
+}
+
+void BeliefSupport::removeEmptyCells(const ProbabilityGrid& belief_map)
+{
+    int num_kept_cells = 0;
+
+    for (int position = 0 ; position < (int) cells_.size() ; position++)
+    {
+        int cell = cells_[position];
+        if (belief_map.get(cell) != 0)
+            cells_[num_kept_cells++] = cell;
+        else
+            is_active_[cell] = false;
+    }
+
+    cells_.resize(num_kept_cells);
+}
+
+double BeliefSupport::prune(ProbabilityGrid& belief_map, float threshold)
+{
+    if (threshold <= 0)
+        return 0;
+
+    double total_probability = 0;
+    for (int position = 0 ; position < (int) cells_.size() ; position++)
+        total_probability += belief_map.get(cells_[position]);
+
+    float pruning_limit = threshold * total_probability;
+    double kept_probability = 0;
+    for (int position = 0 ; position < (int) cells_.size() ; position++)
+    {
+        float probability = belief_map.get(cells_[position]);
+        if (probability >= pruning_limit)
+            kept_probability += probability;
+    }
+
+    if (kept_probability == total_probability || kept_probability == 0)
+        return 0;
+
+    float factor = total_probability / kept_probability;
+    for (int position = 0 ; position < (int) cells_.size() ; position++)
+    {
+        int cell = cells_[position];
+        float probability = belief_map.get(cell);
+        belief_map.set(cell, (probability >= pruning_limit) ? probability * factor : 0);
+    }
+    removeEmptyCells(belief_map);
+
+    return 1 - kept_probability / total_probability;
+}
+
+void BeliefSupport::swap(BeliefSupport& other)
+{
+    std::swap(width_, other.width_);
+    std::swap(height_, other.height_);
+    cells_.swap(other.cells_);
+    is_active_.swap(other.is_active_);
+}
+
+int BeliefSupport::size()
+{
+    return cells_.size();
+}
+
+int BeliefSupport::getCell(int position)
+{
+    return cells_[position];
+}
+
+int BeliefSupport::getX(int position)
+{
+    return cells_[position] % width_;
+}
+
+int BeliefSupport::getY(int position)
+{
+    return cells_[position] / width_;
+}
@@ -0,0 +1,344 @@
+#include "pacman_abstract_classes/distance_matrix.h"
+
+#include "ros/ros.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sstream>
+#include <iomanip>
+
+#include <boost/bind.hpp>
+#include <boost/ref.hpp>
+#include <boost/thread.hpp>
+
+// cache file starts with this header, distances follow as num_cells * num_cells uint16_t
+struct DistanceCacheHeader
+{
+    char magic[8];
+    uint32_t version;
+    int32_t width;
+    int32_t height;
+    uint32_t reserved;
+    uint64_t layout_hash;
+};
+
+static const char DISTANCE_CACHE_MAGIC[8] = "PACDIST";
+static const uint32_t DISTANCE_CACHE_VERSION = 1;
+
+struct DistanceArrayDeleter
+{
+    void operator()(uint16_t *distances)
+    {
+        delete[] distances;
+    }
+};
+
+struct DistanceMappingDeleter
+{
+    size_t length_;
+    DistanceMappingDeleter(size_t length) : length_(length) {}
+    void operator()(void *address)
+    {
+        munmap(address, length_);
+    }
+};
+
+static bool makeDirectories(const std::string& path)
+{
+    for (size_t position = 1 ; position <= path.size() ; position++)
+    {
+        if (position == path.size() || path[position] == '/')
+        {
+            std::string directory = path.substr(0, position);
+            if (mkdir(directory.c_str(), 0755) != 0 && errno != EEXIST)
+                return false;
+        }
+    }
+    return true;
+}
+
+DistanceMatrix::DistanceMatrix()
+{
+    width_ = 0;
+    height_ = 0;
+    num_cells_ = 0;
+    layout_hash_ = 0;
+    distances_ = NULL;
+}
+
+DistanceMatrix::DistanceMatrix(int width, int height, const std::vector<bool>& open_cells, const std::string& cache_directory)
+{
+    width_ = width;
+    height_ = height;
+    num_cells_ = width * height;
+    layout_hash_ = hashLayout(width, height, open_cells);
+    distances_ = NULL;
+    unreachable_row_ = std::vector<uint16_t> (num_cells_, 0);
+
+    if (cache_directory.empty())
+    {
+        calculate(open_cells);
+        return;
+    }
+
+    std::stringstream cache_file;
+    cache_file << cache_directory << "/" << std::hex << std::setw(16) << std::setfill('0') << layout_hash_ << ".dist";
+
+    if (loadCache(cache_file.str()))
+    {
+        ROS_DEBUG_STREAM("Mapped distances from " << cache_file.str());
+        return;
+    }
+
+    calculate(open_cells);
+
+    if (makeDirectories(cache_directory))
+        writeCache(cache_file.str());
+    else
+        ROS_WARN_STREAM("Could not create distance cache directory " << cache_directory);
+}
+
+DistanceMatrix::~DistanceMatrix()
+{
+    unreachable_row_.clear();
+}
+
+uint64_t DistanceMatrix::hashLayout(int width, int height, const std::vector<bool>& open_cells)
+{
+    // FNV-1a over the map size and the wall grid
+    uint64_t FNV_PRIME = 1099511628211ULL;
+    uint64_t hash = 14695981039346656037ULL;
+
+    int values[2] = {width, height};
+    for (int k = 0 ; k < 2 ; k++)
+    {
+        for (int byte = 0 ; byte < 4 ; byte++)
+        {
+            hash ^= (values[k] >> (8 * byte)) & 0xff;
+            hash *= FNV_PRIME;
+        }
+    }
+
+    for (int cell = 0 ; cell < width * height ; cell++)
+    {
+        hash ^= open_cells[cell] ? 1 : 0;
+        hash *= FNV_PRIME;
+    }
+
+    return hash;
+}
+
+std::string DistanceMatrix::getDefaultCacheDirectory()
+{
+    const char *ros_home = getenv("ROS_HOME");
+    if (ros_home != NULL && ros_home[0] != '\0')
+        return std::string(ros_home) + "/pacman_distances";
+
+    const char *home = getenv("HOME");
+    if (home != NULL && home[0] != '\0')
+        return std::string(home) + "/.ros/pacman_distances";
+
+    return "";
+}
+
+void DistanceMatrix::calculate(const std::vector<bool>& open_cells)
+{
+    uint16_t *distances = new uint16_t[(size_t) num_cells_ * num_cells_]();
+    storage_ = boost::shared_ptr<const void> (distances, DistanceArrayDeleter());
+    distances_ = distances;
+
+    // each origin only writes its own row, so threads never share output
+    int num_threads = boost::thread::hardware_concurrency();
+    if (num_threads > num_cells_)
+        num_threads = num_cells_;
+    if (num_threads < 1)
+        num_threads = 1;
+
+    boost::thread_group threads;
+    for (int thread_index = 1 ; thread_index < num_threads ; thread_index++)
+        threads.create_thread(boost::bind(&DistanceMatrix::calculateDistances, this,
+                            thread_index, num_threads, boost::cref(open_cells), distances));
+
+    calculateDistances(0, num_threads, open_cells, distances);
+    threads.join_all();
+}
+
+void DistanceMatrix::calculateDistances(int first_origin, int origin_step, const std::vector<bool>& open_cells, uint16_t *distances)
+{
+    std::vector<int> queue (num_cells_);
+
+    for (int origin = first_origin ; origin < num_cells_ ; origin += origin_step)
+    {
+        if (!open_cells[origin])
+            continue;
+
+        // rows start zeroed, so a zero outside the origin marks a cell not visited yet
+        uint16_t *row = distances + (size_t) origin * num_cells_;
+
+        int queue_begin = 0;
+        int queue_end = 0;
+        queue[queue_end++] = origin;
+
+        while (queue_begin < queue_end)
+        {
+            int cell = queue[queue_begin++];
+            int x = cell % width_;
+            int y = cell / width_;
+
+            int neighbours[4];
+            int num_neighbours = 0;
+            if (y + 1 < height_)
+                neighbours[num_neighbours++] = cell + width_;
+            if (y > 0)
+                neighbours[num_neighbours++] = cell - width_;
+            if (x + 1 < width_)
+                neighbours[num_neighbours++] = cell + 1;
+            if (x > 0)
+                neighbours[num_neighbours++] = cell - 1;
+
+            for (int k = 0 ; k < num_neighbours ; k++)
+            {
+                int next_cell = neighbours[k];
+                if (open_cells[next_cell] && next_cell != origin && row[next_cell] == 0)
+                {
+                    row[next_cell] = row[cell] + 1;
+                    queue[queue_end++] = next_cell;
+                }
+            }
+        }
+    }
+}
+
+bool DistanceMatrix::loadCache(const std::string& cache_file)
+{
+    int file_descriptor = open(cache_file.c_str(), O_RDONLY);
+    if (file_descriptor < 0)
+        return false;
+
+    size_t length = sizeof(DistanceCacheHeader) + (size_t) num_cells_ * num_cells_ * sizeof(uint16_t);
+    struct stat file_status;
+    if (fstat(file_descriptor, &file_status) != 0 || (size_t) file_status.st_size != length)
+    {
+        close(file_descriptor);
+        return false;
+    }
+
+    void *address = mmap(NULL, length, PROT_READ, MAP_SHARED, file_descriptor, 0);
+    close(file_descriptor);
+    if (address == MAP_FAILED)
+        return false;
+
+    const DistanceCacheHeader *header = (const DistanceCacheHeader*) address;
+    if (memcmp(header->magic, DISTANCE_CACHE_MAGIC, sizeof(header->magic)) != 0 ||
+        header->version != DISTANCE_CACHE_VERSION || header->width != width_ ||
+        header->height != height_ || header->layout_hash != layout_hash_)
+    {
+        munmap(address, length);
+        return false;
+    }
+
+    storage_ = boost::shared_ptr<const void> (address, DistanceMappingDeleter(length));
+    distances_ = (const uint16_t*) ((const char*) address + sizeof(DistanceCacheHeader));
+    return true;
+}
+
+void DistanceMatrix::writeCache(const std::string& cache_file)
+{
+    // write a private file and rename it, so concurrent processes never map a partial table
+    std::stringstream temporary_file;
+    temporary_file << cache_file << ".tmp" << getpid();
+
+    FILE *file = fopen(temporary_file.str().c_str(), "wb");
+    if (file == NULL)
+    {
+        ROS_WARN_STREAM("Could not write distance cache " << cache_file);
+        return;
+    }
+
+    DistanceCacheHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, DISTANCE_CACHE_MAGIC, sizeof(header.magic));
+    header.version = DISTANCE_CACHE_VERSION;
+    header.width = width_;
+    header.height = height_;
+    header.layout_hash = layout_hash_;
+
+    size_t num_distances = (size_t) num_cells_ * num_cells_;
+    bool written = fwrite(&header, sizeof(header), 1, file) == 1 &&
+                   fwrite(distances_, sizeof(uint16_t), num_distances, file) == num_distances;
+    written = (fclose(file) == 0) && written;
+
+    if (!written || rename(temporary_file.str().c_str(), cache_file.c_str()) != 0)
+    {
+        unlink(temporary_file.str().c_str());
+        ROS_WARN_STREAM("Could not write distance cache " << cache_file);
+    }
+}
+
+int DistanceMatrix::getWidth() const
+{
+    return width_;
+}
+
+int DistanceMatrix::getHeight() const
+{
+    return height_;
+}
+
+int DistanceMatrix::getNumberOfCells() const
+{
+    return num_cells_;
+}
+
+uint64_t DistanceMatrix::getLayoutHash() const
+{
+    return layout_hash_;
+}
+
+int DistanceMatrix::getCell(int x, int y) const
+{
+    if (x < 0 || x >= width_ || y < 0 || y >= height_)
+        return -1;
+
+    return y * width_ + x;
+}
+
+const uint16_t* DistanceMatrix::getDistanceRow(int cell) const
+{
+    // an empty matrix has no row to read, not even the unreachable one
+    if (num_cells_ == 0)
+        return NULL;
+
+    if (cell < 0 || cell >= num_cells_)
+        return &unreachable_row_[0];
+
+    return distances_ + (size_t) cell * num_cells_;
+}
+
+const uint16_t* DistanceMatrix::getDistanceRow(int x, int y) const
+{
+    return getDistanceRow(getCell(x, y));
+}
+
+int DistanceMatrix::distance(int from_cell, int to_cell) const
+{
+    if (from_cell < 0 || from_cell >= num_cells_ || to_cell < 0 || to_cell >= num_cells_)
+        return 0;
+
+    return distances_[(size_t) from_cell * num_cells_ + to_cell];
+}
+
+int DistanceMatrix::distance(const uint16_t* distance_row, int x, int y) const
+{
+    int cell = getCell(x, y);
+    if (cell < 0)
+        return 0;
+
+    return distance_row[cell];
+}
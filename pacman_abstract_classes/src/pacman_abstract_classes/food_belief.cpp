@@ -0,0 +1,182 @@
+#include "pacman_abstract_classes/food_belief.h"
+
+FoodBelief::FoodBelief()
+{
+    width_ = 0;
+    height_ = 0;
+    num_present_cells_ = 0;
+}
+
+FoodBelief::FoodBelief(int width, int height)
+{
+    width_ = width;
+    height_ = height;
+    num_present_cells_ = 0;
+    present_bits_ = std::vector<uint64_t> ( (width * height + 63) / 64, 0);
+    uncertain_positions_ = std::vector<int> (width * height, -1);
+}
+
+FoodBelief::~FoodBelief()
+{
+    present_bits_.clear();
+    uncertain_cells_.clear();
+    uncertain_probabilities_.clear();
+    uncertain_positions_.clear();
+}
+
+bool FoodBelief::isPresent(int cell) const
+{
+    return ( present_bits_[cell / 64] >> (cell % 64) ) & 1;
+}
+
+void FoodBelief::setPresent(int cell, bool is_present)
+{
+    if (isPresent(cell) == is_present)
+        return;
+
+    present_bits_[cell / 64] ^= ( (uint64_t) 1 ) << (cell % 64);
+    num_present_cells_ += is_present ? 1 : -1;
+}
+
+void FoodBelief::removeUncertain(int cell)
+{
+    int position = uncertain_positions_[cell];
+    if (position < 0)
+        return;
+
+    // the last uncertain cell takes its place
+    int last_cell = uncertain_cells_.back();
+    uncertain_cells_[position] = last_cell;
+    uncertain_probabilities_[position] = uncertain_probabilities_.back();
+    uncertain_positions_[last_cell] = position;
+
+    uncertain_cells_.pop_back();
+    uncertain_probabilities_.pop_back();
+    uncertain_positions_[cell] = -1;
+}
+
+void FoodBelief::rebuild(const ProbabilityGrid& food_map)
+{
+    *this = FoodBelief(food_map.getWidth(), food_map.getHeight());
+
+    for (int cell = 0 ; cell < width_ * height_ ; cell++)
+        set(cell, food_map.get(cell));
+}
+
+void FoodBelief::set(int cell, float probability)
+{
+    if (probability == 1)
+    {
+        removeUncertain(cell);
+        setPresent(cell, true);
+        return;
+    }
+
+    setPresent(cell, false);
+    if (probability == 0)
+    {
+        removeUncertain(cell);
+        return;
+    }
+
+    if (uncertain_positions_[cell] < 0)
+    {
+        uncertain_positions_[cell] = uncertain_cells_.size();
+        uncertain_cells_.push_back(cell);
+        uncertain_probabilities_.push_back(probability);
+    }
+    else
+        uncertain_probabilities_[uncertain_positions_[cell]] = probability;
+}
+
+float FoodBelief::get(int cell) const
+{
+    if (isPresent(cell))
+        return 1;
+    if (uncertain_positions_[cell] < 0)
+        return 0;
+    return uncertain_probabilities_[uncertain_positions_[cell]];
+}
+
+int FoodBelief::getNumberOfPresentCells() const
+{
+    return num_present_cells_;
+}
+
+int FoodBelief::getNumberOfUncertainCells() const
+{
+    return uncertain_cells_.size();
+}
+
+float FoodBelief::getMaxProbability() const
+{
+    float max_probability = (num_present_cells_ > 0) ? 1 : 0;
+
+    for (int position = 0 ; position < (int) uncertain_probabilities_.size() ; position++)
+        max_probability = (uncertain_probabilities_[position] > max_probability) ? uncertain_probabilities_[position] : max_probability;
+
+    return max_probability;
+}
+
+bool FoodBelief::isCloser(int cell, int distance, int closest_cell, int min_distance) const
+{
+    if (distance != min_distance)
+        return distance < min_distance;
+    if (closest_cell < 0)
+        return false;
+
+    int x = cell % width_;
+    int closest_x = closest_cell % width_;
+    return ( x < closest_x ) || ( x == closest_x && cell < closest_cell );
+}
+
+int FoodBelief::findClosestCell(float threshold, const uint16_t *distances, int max_distance, int& min_distance) const
+{
+    int closest_cell = -1;
+    min_distance = max_distance;
+
+    // a threshold of 0 matches every cell, even those known to have no food
+    if (threshold <= 0)
+    {
+        for (int cell = 0 ; cell < width_ * height_ ; cell++)
+        {
+            if (get(cell) >= threshold && isCloser(cell, distances[cell], closest_cell, min_distance))
+            {
+                closest_cell = cell;
+                min_distance = distances[cell];
+            }
+        }
+        return closest_cell;
+    }
+
+    if (threshold <= 1)
+    {
+        for (int word = 0 ; word < (int) present_bits_.size() ; word++)
+        {
+            uint64_t bits = present_bits_[word];
+            while (bits != 0)
+            {
+                int cell = word * 64 + __builtin_ctzll(bits);
+                bits &= bits - 1;
+
+                if (isCloser(cell, distances[cell], closest_cell, min_distance))
+                {
+                    closest_cell = cell;
+                    min_distance = distances[cell];
+                }
+            }
+        }
+    }
+
+    for (int position = 0 ; position < (int) uncertain_cells_.size() ; position++)
+    {
+        int cell = uncertain_cells_[position];
+        if (uncertain_probabilities_[position] >= threshold && isCloser(cell, distances[cell], closest_cell, min_distance))
+        {
+            closest_cell = cell;
+            min_distance = distances[cell];
+        }
+    }
+
+    return closest_cell;
+}
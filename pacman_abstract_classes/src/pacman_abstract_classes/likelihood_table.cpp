@@ -0,0 +1,125 @@
+#include "pacman_abstract_classes/likelihood_table.h"
+
+#include <math.h>
+#include <algorithm>
+
+// same cut as ObservationEngine kernels, e^-40 is already below float precision
+double LikelihoodTable::MAX_WINDOW_EXPONENT = 40.0;
+
+boost::mutex LikelihoodTable::tables_mutex_;
+std::map< std::pair<double, int>, LikelihoodTable > LikelihoodTable::tables_;
+
+LikelihoodTable::LikelihoodTable()
+{
+    standard_deviation_ = 0;
+    max_offset_ = -1;
+}
+
+LikelihoodTable::LikelihoodTable(double standard_deviation, int max_offset)
+{
+    standard_deviation_ = standard_deviation;
+    max_offset_ = max_offset;
+
+    double variance_2 = 2 * standard_deviation * standard_deviation;
+    weights_ = std::vector<double> (2 * max_offset + 1, 0);
+    for (int offset = 0 ; offset <= max_offset ; offset++)
+    {
+        double weight = exp( - (offset * offset) / variance_2 );
+        weights_[max_offset + offset] = weight;
+        weights_[max_offset - offset] = weight;
+    }
+}
+
+LikelihoodTable::~LikelihoodTable()
+{
+    weights_.clear();
+}
+
+const LikelihoodTable& LikelihoodTable::getTable(double standard_deviation, int max_offset)
+{
+    boost::mutex::scoped_lock lock(tables_mutex_);
+
+    // map nodes never move, so references handed out before an insertion stay valid
+    std::pair<double, int> key (standard_deviation, max_offset);
+    std::map< std::pair<double, int>, LikelihoodTable >::iterator it = tables_.find(key);
+    if (it == tables_.end())
+        it = tables_.insert(std::make_pair(key, LikelihoodTable(standard_deviation, max_offset))).first;
+
+    return it->second;
+}
+
+bool LikelihoodTable::isNearlyDeterministic(double standard_deviation)
+{
+    return 3 * standard_deviation < 0.5;
+}
+
+double LikelihoodTable::getStandardDeviation() const
+{
+    return standard_deviation_;
+}
+
+int LikelihoodTable::getMaxOffset() const
+{
+    return max_offset_;
+}
+
+int LikelihoodTable::getWeightIndex(int offset) const
+{
+    if (offset < -max_offset_ || offset > max_offset_)
+        return -1;
+
+    return offset + max_offset_;
+}
+
+double LikelihoodTable::getWeight(int offset) const
+{
+    int weight_index = getWeightIndex(offset);
+    if (weight_index < 0)
+        return 0.0;
+
+    return weights_[weight_index];
+}
+
+double LikelihoodTable::getLikelihood(int x_offset, int y_offset) const
+{
+    return getWeight(x_offset) * getWeight(y_offset);
+}
+
+void LikelihoodTable::getAxisWeights(double measurement, int size, std::vector<double>& weights) const
+{
+    weights.resize(size);
+
+    // both ends of the axis must be in the table for the lookups to be exact
+    int integer_measurement = (int) floor(measurement);
+    if (integer_measurement == measurement &&
+        getWeightIndex(integer_measurement) >= 0 && getWeightIndex(integer_measurement - size + 1) >= 0)
+    {
+        for (int position = 0 ; position < size ; position++)
+            weights[position] = getWeight(integer_measurement - position);
+        return;
+    }
+
+    // offsets to a fractional measurement are not in the table, so the window around the closest position is evaluated
+    double variance_2 = 2 * standard_deviation_ * standard_deviation_;
+    double closest_position = floor(measurement + 0.5);
+    if (closest_position < 0)
+        closest_position = 0;
+    if (closest_position > size - 1)
+        closest_position = size - 1;
+    double closest_diff = measurement - closest_position;
+    double radius = sqrt(MAX_WINDOW_EXPONENT * variance_2 + closest_diff * closest_diff);
+
+    int first_position = (int) ceil(measurement - radius);
+    int last_position = (int) floor(measurement + radius);
+    if (first_position < 0)
+        first_position = 0;
+    if (last_position > size - 1)
+        last_position = size - 1;
+
+    std::fill(weights.begin(), weights.end(), 0.0);
+    for (int position = first_position ; position <= last_position ; position++)
+    {
+        double diff = measurement - position;
+        weights[position] = exp( - (diff * diff) / variance_2 );
+    }
+}
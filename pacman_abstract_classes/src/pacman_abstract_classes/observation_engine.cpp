@@ -0,0 +1,197 @@
+#include "pacman_abstract_classes/observation_engine.h"
+#include "pacman_abstract_classes/likelihood_table.h"
+
+#include <math.h>
+#include <boost/bind.hpp>
+
+// e^-40 is already below float precision, so farther offsets can't change a normalized belief
+double ObservationEngine::MAX_KERNEL_EXPONENT = 40.0;
+int ObservationEngine::MIN_BAND_CELLS = 4096;
+
+ObservationEngine::ObservationEngine(double standard_deviation)
+{
+    standard_deviation_ = standard_deviation;
+    task_scheduler_ = NULL;
+    first_x_offset_ = 0;
+    first_y_offset_ = 0;
+}
+
+ObservationEngine::~ObservationEngine()
+{
+}
+
+double ObservationEngine::getStandardDeviation()
+{
+    return standard_deviation_;
+}
+
+bool ObservationEngine::isNearlyDeterministic()
+{
+    return LikelihoodTable::isNearlyDeterministic(standard_deviation_);
+}
+
+void ObservationEngine::setTaskScheduler(TaskScheduler *task_scheduler)
+{
+    task_scheduler_ = task_scheduler;
+}
+
+int ObservationEngine::getAxisKernel(double measurement, int max_offset, std::vector<double>& weights)
+{
+    // weights are scaled by the weight of the integer offset closest to the measurement,
+    // which cancels out on normalization and keeps sharp sensors from underflowing to zero
+    double variance_2 = 2 * standard_deviation_ * standard_deviation_;
+    double closest_diff = measurement - floor(measurement + 0.5);
+    double radius = sqrt(MAX_KERNEL_EXPONENT * variance_2 + closest_diff * closest_diff);
+
+    int first_offset = (int) ceil(measurement - radius);
+    int last_offset = (int) floor(measurement + radius);
+    if (first_offset < -max_offset)
+        first_offset = -max_offset;
+    if (last_offset > max_offset)
+        last_offset = max_offset;
+
+    weights.clear();
+    for (int offset = first_offset ; offset <= last_offset ; offset++)
+    {
+        double diff = measurement - offset;
+        weights.push_back( exp( - (diff*diff - closest_diff*closest_diff) / variance_2 ) );
+    }
+
+    return first_offset;
+}
+
+void ObservationEngine::setMeasurement(double measurement_x_dist, double measurement_y_dist, int width, int height)
+{
+    first_x_offset_ = getAxisKernel(measurement_x_dist, width - 1, x_weights_);
+    first_y_offset_ = getAxisKernel(measurement_y_dist, height - 1, y_weights_);
+}
+
+double ObservationEngine::getOffsetLikelihood(int x_dist, int y_dist)
+{
+    int x_position = x_dist - first_x_offset_;
+    int y_position = y_dist - first_y_offset_;
+
+    if (x_position < 0 || x_position >= (int) x_weights_.size() ||
+        y_position < 0 || y_position >= (int) y_weights_.size())
+        return 0.0;
+
+    return x_weights_[x_position] * y_weights_[y_position];
+}
+
+template <class Grid>
+void ObservationEngine::correlate(const Grid& origin_map, double measurement_x_dist, double measurement_y_dist,
+                                int width, int height, Grid& row_likelihood, Grid& likelihood_map)
+{
+    setMeasurement(measurement_x_dist, measurement_y_dist, width, height);
+
+    if (x_weights_.size() == 0 || y_weights_.size() == 0)
+        return;
+
+    // every output row only depends on its inputs, so bands of rows give the same result as one sweep
+    std::vector<char> row_has_mass (height, false);
+    TaskScheduler::RangeTask correlate_rows = boost::bind(&ObservationEngine::correlateRows<Grid>, this,
+                                &origin_map, width, &row_likelihood, &row_has_mass, _1, _2);
+    TaskScheduler::RangeTask correlate_columns = boost::bind(&ObservationEngine::correlateColumns<Grid>, this,
+                                width, height, &row_likelihood, &row_has_mass, &likelihood_map, _1, _2);
+
+    if (task_scheduler_ == NULL || width == 0)
+    {
+        correlate_rows(0, height);
+        correlate_columns(0, height);
+        return;
+    }
+
+    int min_band_rows = MIN_BAND_CELLS / width + 1;
+    task_scheduler_->parallelFor(0, height, min_band_rows, correlate_rows);
+    task_scheduler_->parallelFor(0, height, min_band_rows, correlate_columns);
+}
+
+template <class Grid>
+void ObservationEngine::correlateRows(const Grid *origin_map, int width, Grid *row_likelihood,
+                                std::vector<char> *row_has_mass, int first_row, int end_row)
+{
+    int num_x_offsets = x_weights_.size();
+
+    // correlate along x: row_likelihood[oy][x] = sum_dx w_x(dx) * origin_map[oy][x - dx]
+    for (int origin_y = first_row ; origin_y < end_row ; origin_y++)
+    {
+        for (int origin_x = 0 ; origin_x < width ; origin_x++)
+        {
+            if ((*origin_map)[origin_y][origin_x] != 0)
+            {
+                (*row_has_mass)[origin_y] = true;
+                break;
+            }
+        }
+        if (!(*row_has_mass)[origin_y])
+            continue;
+
+        for (int x = 0 ; x < width ; x++)
+        {
+            double sum = 0.0;
+            for (int k = 0 ; k < num_x_offsets ; k++)
+            {
+                int origin_x = x - (first_x_offset_ + k);
+                if (origin_x >= 0 && origin_x < width)
+                    sum += x_weights_[k] * (*origin_map)[origin_y][origin_x];
+            }
+            (*row_likelihood)[origin_y][x] = sum;
+        }
+    }
+}
+
+template <class Grid>
+void ObservationEngine::correlateColumns(int width, int height, const Grid *row_likelihood,
+                                const std::vector<char> *row_has_mass, Grid *likelihood_map, int first_row, int end_row)
+{
+    int num_y_offsets = y_weights_.size();
+
+    // correlate along y: likelihood_map[y][x] = sum_dy w_y(dy) * row_likelihood[y - dy][x]
+    for (int y = first_row ; y < end_row ; y++)
+    {
+        for (int k = 0 ; k < num_y_offsets ; k++)
+        {
+            int origin_y = y - (first_y_offset_ + k);
+            if (origin_y < 0 || origin_y >= height || !(*row_has_mass)[origin_y])
+                continue;
+
+            float weight = y_weights_[k];
+            for (int x = 0 ; x < width ; x++)
+                (*likelihood_map)[y][x] += weight * (*row_likelihood)[origin_y][x];
+        }
+    }
+}
+
+std::vector< std::vector<float> > ObservationEngine::getRelativeMeasurementLikelihood(const std::vector< std::vector<float> >& origin_map,
+                                double measurement_x_dist, double measurement_y_dist)
+{
+    int height = origin_map.size();
+    int width = (height > 0) ? origin_map[0].size() : 0;
+
+    std::vector<float> map_line (width, 0);
+    std::vector< std::vector<float> > likelihood_map (height, map_line);
+    std::vector< std::vector<float> > row_likelihood (height, map_line);
+
+    correlate(origin_map, measurement_x_dist, measurement_y_dist, width, height, row_likelihood, likelihood_map);
+
+    return likelihood_map;
+}
+
+ProbabilityGrid ObservationEngine::getRelativeMeasurementLikelihood(const ProbabilityGrid& origin_map,
+                                double measurement_x_dist, double measurement_y_dist)
+{
+    // the correlation reads float rows
+    if (origin_map.getStorage() != ProbabilityGrid::FLOAT)
+        return getRelativeMeasurementLikelihood(ProbabilityGrid(origin_map, ProbabilityGrid::FLOAT),
+                                measurement_x_dist, measurement_y_dist);
+
+    int height = origin_map.getHeight();
+    int width = origin_map.getWidth();
+
+    ProbabilityGrid likelihood_map (width, height);
+    ProbabilityGrid row_likelihood (width, height);
+
+    correlate(origin_map, measurement_x_dist, measurement_y_dist, width, height, row_likelihood, likelihood_map);
+
+    return likelihood_map;
+}
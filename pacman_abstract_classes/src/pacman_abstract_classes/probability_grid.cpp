@@ -0,0 +1,369 @@
+#include "pacman_abstract_classes/probability_grid.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <new>
+
+// enough for 256 bit vector loads
+int ProbabilityGrid::ALIGNMENT = 32;
+
+ProbabilityGrid::ProbabilityGrid()
+{
+    width_ = 0;
+    height_ = 0;
+    size_ = 0;
+    storage_ = FLOAT;
+    data_ = NULL;
+    quantized_data_ = NULL;
+}
+
+ProbabilityGrid::ProbabilityGrid(int width, int height, float value, Storage storage)
+{
+    width_ = width;
+    height_ = height;
+    storage_ = storage;
+    data_ = NULL;
+    quantized_data_ = NULL;
+    allocate(width * height);
+    fill(value);
+}
+
+ProbabilityGrid::ProbabilityGrid(const ProbabilityGrid& other)
+{
+    width_ = other.width_;
+    height_ = other.height_;
+    storage_ = other.storage_;
+    data_ = NULL;
+    quantized_data_ = NULL;
+    allocate(other.size_);
+    copyCells(other);
+    open_cells_mask_ = other.open_cells_mask_;
+}
+
+ProbabilityGrid::ProbabilityGrid(const ProbabilityGrid& other, Storage storage)
+{
+    width_ = other.width_;
+    height_ = other.height_;
+    storage_ = storage;
+    data_ = NULL;
+    quantized_data_ = NULL;
+    allocate(other.size_);
+    for (int cell = 0 ; cell < size_ ; cell++)
+        set(cell, other.get(cell));
+    open_cells_mask_ = other.open_cells_mask_;
+}
+
+ProbabilityGrid& ProbabilityGrid::operator=(const ProbabilityGrid& other)
+{
+    if (this != &other)
+    {
+        if (size_ != other.size_ || storage_ != other.storage_)
+        {
+            storage_ = other.storage_;
+            allocate(other.size_);
+        }
+        width_ = other.width_;
+        height_ = other.height_;
+        copyCells(other);
+        open_cells_mask_ = other.open_cells_mask_;
+    }
+
+    return *this;
+}
+
+ProbabilityGrid::~ProbabilityGrid()
+{
+    free(data_);
+    free(quantized_data_);
+}
+
+void ProbabilityGrid::allocate(int size)
+{
+    free(data_);
+    free(quantized_data_);
+    data_ = NULL;
+    quantized_data_ = NULL;
+    size_ = size;
+
+    if (size_ > 0)
+    {
+        void *memory = NULL;
+        if (posix_memalign(&memory, ALIGNMENT, size_ * getCellBytes()) != 0)
+            throw std::bad_alloc();
+
+        if (storage_ == FLOAT)
+            data_ = (float *) memory;
+        else
+            quantized_data_ = (uint16_t *) memory;
+    }
+}
+
+void ProbabilityGrid::copyCells(const ProbabilityGrid& other)
+{
+    if (size_ == 0)
+        return;
+
+    if (storage_ == FLOAT)
+        memcpy(data_, other.data_, getMemorySize());
+    else
+        memcpy(quantized_data_, other.quantized_data_, getMemorySize());
+}
+
+int ProbabilityGrid::getCellBytes() const
+{
+    return (storage_ == FLOAT) ? sizeof(float) : sizeof(uint16_t);
+}
+
+int ProbabilityGrid::getWidth() const
+{
+    return width_;
+}
+
+int ProbabilityGrid::getHeight() const
+{
+    return height_;
+}
+
+int ProbabilityGrid::getSize() const
+{
+    return size_;
+}
+
+ProbabilityGrid::Storage ProbabilityGrid::getStorage() const
+{
+    return storage_;
+}
+
+int ProbabilityGrid::getMemorySize() const
+{
+    return size_ * getCellBytes();
+}
+
+void ProbabilityGrid::setStorage(Storage storage)
+{
+    if (storage == storage_)
+        return;
+
+    ProbabilityGrid converted_grid (*this, storage);
+    swap(converted_grid);
+}
+
+float *ProbabilityGrid::operator[](int y)
+{
+    return data_ + y * width_;
+}
+
+const float *ProbabilityGrid::operator[](int y) const
+{
+    return data_ + y * width_;
+}
+
+float *ProbabilityGrid::data()
+{
+    return data_;
+}
+
+const float *ProbabilityGrid::data() const
+{
+    return data_;
+}
+
+void ProbabilityGrid::setOpenCellsMask(const boost::shared_ptr< const std::vector<float> >& open_cells_mask)
+{
+    open_cells_mask_ = open_cells_mask;
+}
+
+const boost::shared_ptr< const std::vector<float> >& ProbabilityGrid::getOpenCellsMask() const
+{
+    return open_cells_mask_;
+}
+
+void ProbabilityGrid::swap(ProbabilityGrid& other)
+{
+    std::swap(width_, other.width_);
+    std::swap(height_, other.height_);
+    std::swap(size_, other.size_);
+    std::swap(storage_, other.storage_);
+    std::swap(data_, other.data_);
+    std::swap(quantized_data_, other.quantized_data_);
+    open_cells_mask_.swap(other.open_cells_mask_);
+}
+
+void ProbabilityGrid::fill(float value)
+{
+    if (storage_ != FLOAT)
+    {
+        std::fill(quantized_data_, quantized_data_ + size_, encode(value, storage_));
+        return;
+    }
+
+    float *data = data_;
+    for (int cell = 0 ; cell < size_ ; cell++)
+        data[cell] = value;
+}
+
+void ProbabilityGrid::fillOpenCells(float value)
+{
+    if (!open_cells_mask_)
+    {
+        fill(value);
+        return;
+    }
+
+    const float *mask = &(*open_cells_mask_)[0];
+    if (storage_ != FLOAT)
+    {
+        for (int cell = 0 ; cell < size_ ; cell++)
+            set(cell, value * mask[cell]);
+        return;
+    }
+
+    float *data = data_;
+    for (int cell = 0 ; cell < size_ ; cell++)
+        data[cell] = value * mask[cell];
+}
+
+void ProbabilityGrid::applyOpenCellsMask()
+{
+    if (!open_cells_mask_)
+        return;
+
+    const float *mask = &(*open_cells_mask_)[0];
+    if (storage_ != FLOAT)
+    {
+        for (int cell = 0 ; cell < size_ ; cell++)
+            set(cell, get(cell) * mask[cell]);
+        return;
+    }
+
+    float *data = data_;
+    for (int cell = 0 ; cell < size_ ; cell++)
+        data[cell] *= mask[cell];
+}
+
+void ProbabilityGrid::multiply(const ProbabilityGrid& other)
+{
+    if (storage_ != FLOAT || other.storage_ != FLOAT)
+    {
+        for (int cell = 0 ; cell < size_ ; cell++)
+            set(cell, get(cell) * other.get(cell));
+        return;
+    }
+
+    float *data = data_;
+    const float *other_data = other.data_;
+    for (int cell = 0 ; cell < size_ ; cell++)
+        data[cell] *= other_data[cell];
+}
+
+void ProbabilityGrid::scale(float factor)
+{
+    if (storage_ != FLOAT)
+    {
+        for (int cell = 0 ; cell < size_ ; cell++)
+            set(cell, get(cell) * factor);
+        return;
+    }
+
+    float *data = data_;
+    for (int cell = 0 ; cell < size_ ; cell++)
+        data[cell] *= factor;
+}
+
+double ProbabilityGrid::sum() const
+{
+    // four partial sums break the dependency chain of a single accumulator
+    double partial_sums[4] = {0.0, 0.0, 0.0, 0.0};
+    int cell = 0;
+
+    if (storage_ != FLOAT)
+    {
+        for ( ; cell < size_ ; cell++)
+            partial_sums[cell & 3] += get(cell);
+
+        return (partial_sums[0] + partial_sums[1]) + (partial_sums[2] + partial_sums[3]);
+    }
+
+    const float *data = data_;
+    for ( ; cell + 3 < size_ ; cell += 4)
+    {
+        partial_sums[0] += data[cell];
+        partial_sums[1] += data[cell + 1];
+        partial_sums[2] += data[cell + 2];
+        partial_sums[3] += data[cell + 3];
+    }
+    for ( ; cell < size_ ; cell++)
+        partial_sums[0] += data[cell];
+
+    return (partial_sums[0] + partial_sums[1]) + (partial_sums[2] + partial_sums[3]);
+}
+
+bool ProbabilityGrid::normalize()
+{
+    double total = sum();
+    if (total == 0)
+        return false;
+
+    if (storage_ != FLOAT)
+    {
+        for (int cell = 0 ; cell < size_ ; cell++)
+            set(cell, get(cell) / total);
+        return true;
+    }
+
+    float *data = data_;
+    for (int cell = 0 ; cell < size_ ; cell++)
+        data[cell] = data[cell] / total;
+
+    return true;
+}
+
+float ProbabilityGrid::max() const
+{
+    float max_probability = (size_ > 0) ? get(0) : 0;
+
+    if (storage_ != FLOAT)
+    {
+        for (int cell = 1 ; cell < size_ ; cell++)
+            max_probability = std::max(max_probability, get(cell));
+        return max_probability;
+    }
+
+    const float *data = data_;
+    for (int cell = 1 ; cell < size_ ; cell++)
+        max_probability = (data[cell] > max_probability) ? data[cell] : max_probability;
+
+    return max_probability;
+}
+
+int ProbabilityGrid::argmax() const
+{
+    // ties go to the lowest x and then the lowest y, so the sweep for the first maximum goes column by column
+    float max_probability = max();
+
+    for (int x = 0 ; x < width_ ; x++)
+        for (int cell = x ; cell < size_ ; cell += width_)
+            if (get(cell) == max_probability)
+                return cell;
+
+    return -1;
+}
+
+int ProbabilityGrid::countAtLeast(float threshold) const
+{
+    int count = 0;
+
+    if (storage_ != FLOAT)
+    {
+        for (int cell = 0 ; cell < size_ ; cell++)
+            count += (get(cell) >= threshold) ? 1 : 0;
+        return count;
+    }
+
+    const float *data = data_;
+    for (int cell = 0 ; cell < size_ ; cell++)
+        count += (data[cell] >= threshold) ? 1 : 0;
+
+    return count;
+}
@@ -0,0 +1,150 @@
+#include "pacman_abstract_classes/random_stream.h"
+
+#include <ctime>
+
+// PCG32 multiplier, the increment is odd and selects the stream
+static const uint64_t MULTIPLIER = 6364136223846793005ULL;
+// block streams are numbered after every thread stream
+static const uint64_t FIRST_BLOCK_STREAM = (uint64_t) 1 << 32;
+
+struct RandomStream::ThreadStream
+{
+    RandomStream stream;
+    int match_seed_version;
+};
+
+boost::mutex RandomStream::match_seed_mutex_;
+bool RandomStream::is_match_seed_set_ = false;
+uint64_t RandomStream::match_seed_ = 0;
+boost::atomic<int> RandomStream::match_seed_version_ (0);
+uint64_t RandomStream::num_thread_streams_ = 0;
+boost::thread_specific_ptr<RandomStream::ThreadStream> RandomStream::thread_stream_;
+
+RandomStream::RandomStream()
+{
+    seed(0, 0);
+}
+
+RandomStream::RandomStream(uint64_t seed, uint64_t stream_index)
+{
+    this->seed(seed, stream_index);
+}
+
+void RandomStream::seed(uint64_t seed, uint64_t stream_index)
+{
+    increment_ = (stream_index << 1) | 1;
+
+    uint64_t multiplier = MULTIPLIER;
+    uint64_t increment = increment_;
+    for (int lane = 0 ; lane < 4 ; lane++)
+    {
+        lane_multipliers_[lane] = multiplier;
+        lane_increments_[lane] = increment;
+        multiplier = multiplier * MULTIPLIER;
+        increment = increment * MULTIPLIER + increment_;
+    }
+
+    state_ = 0;
+    next();
+    state_ += seed;
+    next();
+}
+
+uint32_t RandomStream::getOutput(uint64_t state)
+{
+    uint32_t xorshifted = ( (state >> 18) ^ state ) >> 27;
+    uint32_t rotation = state >> 59;
+    return (xorshifted >> rotation) | (xorshifted << ( (-rotation) & 31 ));
+}
+
+uint32_t RandomStream::next()
+{
+    uint64_t old_state = state_;
+    state_ = old_state * MULTIPLIER + increment_;
+    return getOutput(old_state);
+}
+
+double RandomStream::getUniform()
+{
+    return next() * (1.0 / 4294967296.0);
+}
+
+int RandomStream::getInt(int n)
+{
+    return ( (uint64_t) next() * n ) >> 32;
+}
+
+void RandomStream::fillUniforms(double *uniforms, int num_uniforms)
+{
+    int k = 0;
+    // the four states of a step only depend on the first one, so the lanes do not wait on each other
+    for ( ; k + 4 <= num_uniforms ; k += 4)
+    {
+        uint64_t state = state_;
+        uniforms[k] = getOutput(state) * (1.0 / 4294967296.0);
+        uniforms[k + 1] = getOutput(state * lane_multipliers_[0] + lane_increments_[0]) * (1.0 / 4294967296.0);
+        uniforms[k + 2] = getOutput(state * lane_multipliers_[1] + lane_increments_[1]) * (1.0 / 4294967296.0);
+        uniforms[k + 3] = getOutput(state * lane_multipliers_[2] + lane_increments_[2]) * (1.0 / 4294967296.0);
+        state_ = state * lane_multipliers_[3] + lane_increments_[3];
+    }
+
+    for ( ; k < num_uniforms ; k++)
+        uniforms[k] = getUniform();
+}
+
+void RandomStream::setMatchSeed(uint64_t seed)
+{
+    boost::mutex::scoped_lock lock(match_seed_mutex_);
+    match_seed_ = seed;
+    is_match_seed_set_ = true;
+    match_seed_version_++;
+}
+
+void RandomStream::initializeMatchSeed()
+{
+    if (is_match_seed_set_)
+        return;
+
+    match_seed_ = std::time(NULL);
+    is_match_seed_set_ = true;
+    match_seed_version_++;
+}
+
+uint64_t RandomStream::getMatchSeed()
+{
+    boost::mutex::scoped_lock lock(match_seed_mutex_);
+    initializeMatchSeed();
+
+    return match_seed_;
+}
+
+RandomStream& RandomStream::getThreadStream()
+{
+    ThreadStream *thread_stream = thread_stream_.get();
+    if (thread_stream && thread_stream->match_seed_version == match_seed_version_.load(boost::memory_order_acquire))
+        return thread_stream->stream;
+
+    boost::mutex::scoped_lock lock(match_seed_mutex_);
+    initializeMatchSeed();
+
+    if (!thread_stream)
+    {
+        thread_stream = new ThreadStream();
+        thread_stream->stream.seed(match_seed_, num_thread_streams_++);
+        thread_stream->match_seed_version = match_seed_version_;
+        thread_stream_.reset(thread_stream);
+    }
+    else if (thread_stream->match_seed_version != match_seed_version_)
+    {
+        // a new match restarts the thread's stream, keeping its index
+        thread_stream->stream.seed(match_seed_, thread_stream->stream.increment_ >> 1);
+        thread_stream->match_seed_version = match_seed_version_;
+    }
+
+    return thread_stream->stream;
+}
+
+RandomStream RandomStream::getBlockStream(uint64_t block)
+{
+    return RandomStream(getMatchSeed(), FIRST_BLOCK_STREAM + block);
+}
@@ -0,0 +1,217 @@
+#include "pacman_abstract_classes/task_scheduler.h"
+
+#include <boost/bind.hpp>
+
+TaskScheduler::TaskScheduler(int num_threads)
+{
+    if (num_threads <= 0)
+        num_threads = boost::thread::hardware_concurrency();
+    if (num_threads < 1)
+        num_threads = 1;
+
+    num_threads_ = num_threads;
+    is_stopping_ = false;
+    active_groups_ = 0;
+    queues_ = std::vector< std::deque<int> > (num_threads_);
+
+    for (int worker_index = 1 ; worker_index < num_threads_ ; worker_index++)
+        workers_.create_thread(boost::bind(&TaskScheduler::workerLoop, this, worker_index));
+}
+
+TaskScheduler::~TaskScheduler()
+{
+    {
+        boost::unique_lock<boost::mutex> lock(mutex_);
+        is_stopping_ = true;
+        condition_.notify_all();
+    }
+    workers_.join_all();
+}
+
+int TaskScheduler::getNumberOfThreads() const
+{
+    return num_threads_;
+}
+
+int TaskScheduler::addTask(const Task& task)
+{
+    return addTask(task, std::vector<int> ());
+}
+
+int TaskScheduler::addTask(const Task& task, int dependency)
+{
+    return addTask(task, std::vector<int> (1, dependency));
+}
+
+int TaskScheduler::addTask(const Task& task, const std::vector<int>& dependencies)
+{
+    boost::unique_lock<boost::mutex> lock(mutex_);
+
+    int task_index = nodes_.size();
+    TaskNode node;
+    node.task = task;
+    node.remaining_dependencies = dependencies.size();
+    node.group = -1;
+    nodes_.push_back(node);
+
+    for(std::vector<int>::const_iterator it = dependencies.begin(); it != dependencies.end(); ++it)
+        nodes_[*it].successors.push_back(task_index);
+
+    unscheduled_tasks_.push_back(task_index);
+    return task_index;
+}
+
+void TaskScheduler::run()
+{
+    boost::unique_lock<boost::mutex> lock(mutex_);
+    if (unscheduled_tasks_.empty())
+        return;
+
+    int worker_index = getWorkerIndex();
+    int group = newGroup(unscheduled_tasks_.size());
+
+    // tasks without dependencies are spread over all deques, the others are released by their last dependency
+    int next_queue = worker_index;
+    for(std::vector<int>::iterator it = unscheduled_tasks_.begin(); it != unscheduled_tasks_.end(); ++it)
+    {
+        nodes_[*it].group = group;
+        if (nodes_[*it].remaining_dependencies == 0)
+        {
+            queues_[next_queue].push_back(*it);
+            next_queue = (next_queue + 1) % num_threads_;
+        }
+    }
+    unscheduled_tasks_.clear();
+
+    waitForGroup(lock, worker_index, group);
+}
+
+void TaskScheduler::parallelFor(int begin, int end, int min_band_size, const RangeTask& range_task)
+{
+    if (min_band_size < 1)
+        min_band_size = 1;
+
+    int num_bands = (end - begin) / min_band_size;
+    if (num_bands > num_threads_)
+        num_bands = num_threads_;
+
+    if (num_bands <= 1)
+    {
+        if (begin < end)
+            range_task(begin, end);
+        return;
+    }
+
+    boost::unique_lock<boost::mutex> lock(mutex_);
+    int worker_index = getWorkerIndex();
+    int group = newGroup(num_bands);
+
+    for (int band = 0 ; band < num_bands ; band++)
+    {
+        int band_begin = begin + (end - begin) * band / num_bands;
+        int band_end = begin + (end - begin) * (band + 1) / num_bands;
+
+        TaskNode node;
+        node.task = boost::bind(range_task, band_begin, band_end);
+        node.remaining_dependencies = 0;
+        node.group = group;
+        queues_[worker_index].push_back(nodes_.size());
+        nodes_.push_back(node);
+    }
+
+    waitForGroup(lock, worker_index, group);
+}
+
+int TaskScheduler::getWorkerIndex()
+{
+    int *worker_index = worker_index_.get();
+    return worker_index ? *worker_index : 0;
+}
+
+int TaskScheduler::newGroup(int num_tasks)
+{
+    group_pending_.push_back(num_tasks);
+    active_groups_++;
+    return group_pending_.size() - 1;
+}
+
+bool TaskScheduler::popTask(int worker_index, int& task_index)
+{
+    std::deque<int>& own_queue = queues_[worker_index];
+    if (!own_queue.empty())
+    {
+        task_index = own_queue.back();
+        own_queue.pop_back();
+        return true;
+    }
+
+    for (int k = 1 ; k < num_threads_ ; k++)
+    {
+        std::deque<int>& queue = queues_[(worker_index + k) % num_threads_];
+        if (!queue.empty())
+        {
+            task_index = queue.front();
+            queue.pop_front();
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void TaskScheduler::executeTask(boost::unique_lock<boost::mutex>& lock, int worker_index, int task_index)
+{
+    // nodes_ may grow while the task runs, so nothing is kept by reference across the unlock
+    Task task = nodes_[task_index].task;
+
+    lock.unlock();
+    task();
+    lock.lock();
+
+    std::vector<int>& successors = nodes_[task_index].successors;
+    for(std::vector<int>::iterator it = successors.begin(); it != successors.end(); ++it)
+    {
+        if (--nodes_[*it].remaining_dependencies == 0)
+            queues_[worker_index].push_back(*it);
+    }
+
+    group_pending_[nodes_[task_index].group]--;
+    condition_.notify_all();
+}
+
+void TaskScheduler::waitForGroup(boost::unique_lock<boost::mutex>& lock, int worker_index, int group)
+{
+    condition_.notify_all();
+
+    while (group_pending_[group] > 0)
+    {
+        int task_index;
+        if (popTask(worker_index, task_index))
+            executeTask(lock, worker_index, task_index);
+        else
+            condition_.wait(lock);
+    }
+
+    // once nothing is being waited on or waiting for a run every node has run, so ids can start over
+    active_groups_--;
+    if (active_groups_ == 0 && unscheduled_tasks_.empty())
+    {
+        nodes_.clear();
+        group_pending_.clear();
+    }
+}
+
+void TaskScheduler::workerLoop(int worker_index)
+{
+    worker_index_.reset(new int(worker_index));
+
+    boost::unique_lock<boost::mutex> lock(mutex_);
+    while (!is_stopping_)
+    {
+        int task_index;
+        if (popTask(worker_index, task_index))
+            executeTask(lock, worker_index, task_index);
+        else
+            condition_.wait(lock);
+    }
+}
@@ -0,0 +1,82 @@
+#include <gtest/gtest.h>
+
+#include "pacman_abstract_classes/belief_support.h"
+#include "pacman_abstract_classes/probability_grid.h"
+
+int WIDTH = 4;
+int HEIGHT = 2;
+
+// belief over the first row, scaled by total
+ProbabilityGrid makeBelief(double total)
+{
+    ProbabilityGrid belief (WIDTH, HEIGHT);
+    belief.set(0, 0.5 * total);
+    belief.set(1, 0.3 * total);
+    belief.set(2, 0.15 * total);
+    belief.set(3, 0.05 * total);
+
+    return belief;
+}
+
+TEST(BeliefSupport, ZeroThresholdKeepsBelief)
+{
+    ProbabilityGrid belief = makeBelief(1);
+    BeliefSupport support (WIDTH, HEIGHT);
+    support.rebuild(belief);
+
+    EXPECT_EQ(0, support.prune(belief, 0));
+    EXPECT_EQ(4, support.size());
+    EXPECT_FLOAT_EQ(0.05, belief.get(3));
+}
+
+TEST(BeliefSupport, PrunedMassIsTheFractionOfTheTotalDropped)
+{
+    ProbabilityGrid belief = makeBelief(1);
+    BeliefSupport support (WIDTH, HEIGHT);
+    support.rebuild(belief);
+
+    EXPECT_NEAR(0.05, support.prune(belief, 0.1), 1e-6);
+
+    // the dropped cell leaves the support and the kept ones take its mass
+    EXPECT_EQ(3, support.size());
+    EXPECT_EQ(0, belief.get(3));
+    EXPECT_NEAR(1.0, belief.sum(), 1e-6);
+    EXPECT_NEAR(0.5 / 0.95, belief.get(0), 1e-6);
+    EXPECT_NEAR(0.15 / 0.95, belief.get(2), 1e-6);
+}
+
+TEST(BeliefSupport, ThresholdIsRelativeToTheTotal)
+{
+    // an unnormalized belief prunes the same cells and reports the same fraction
+    ProbabilityGrid belief = makeBelief(0.02);
+    BeliefSupport support (WIDTH, HEIGHT);
+    support.rebuild(belief);
+
+    EXPECT_NEAR(0.05, support.prune(belief, 0.1), 1e-6);
+    EXPECT_EQ(3, support.size());
+    EXPECT_EQ(0, belief.get(3));
+    EXPECT_NEAR(0.02, belief.sum(), 1e-6);
+}
+
+TEST(BeliefSupport, ThinBeliefIsKeptWhole)
+{
+    ProbabilityGrid belief (WIDTH, HEIGHT, 1.0 / (WIDTH * HEIGHT));
+    BeliefSupport support (WIDTH, HEIGHT);
+    support.rebuild(belief);
+
+    EXPECT_EQ(0, support.prune(belief, 0.5));
+    EXPECT_EQ(WIDTH * HEIGHT, support.size());
+    EXPECT_NEAR(1.0, belief.sum(), 1e-6);
+}
+
+TEST(BeliefSupport, QuantizedBeliefIsPrunedLikeTheFloatOne)
+{
+    ProbabilityGrid belief (makeBelief(1), ProbabilityGrid::BFLOAT16);
+    BeliefSupport support (WIDTH, HEIGHT);
+    support.rebuild(belief);
+
+    EXPECT_NEAR(0.05, support.prune(belief, 0.1), 1.0 / 256);
+    EXPECT_EQ(3, support.size());
+    EXPECT_EQ(0, belief.get(3));
+    EXPECT_NEAR(1.0, belief.sum(), 1.0 / 256);
+}
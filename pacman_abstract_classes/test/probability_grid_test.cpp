@@ -0,0 +1,121 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+
+#include "pacman_abstract_classes/probability_grid.h"
+
+// originalClassic size
+int WIDTH = 28;
+int HEIGHT = 27;
+
+// grid with reproducible values in (0, 1], spread over several orders of magnitude
+ProbabilityGrid makeGrid(ProbabilityGrid::Storage storage)
+{
+    ProbabilityGrid grid (WIDTH, HEIGHT, 0, storage);
+    unsigned int state = 12345;
+    for (int cell = 0 ; cell < grid.getSize() ; cell++)
+    {
+        state = state * 1103515245 + 12345;
+        float value = ( (state >> 8) % 1000 + 1 ) / 1000.0f;
+        grid.set(cell, value * value * value);
+    }
+
+    return grid;
+}
+
+TEST(ProbabilityGrid, FixedPointRoundTripError)
+{
+    ProbabilityGrid grid (1, 1, 0, ProbabilityGrid::FIXED_POINT);
+
+    for (int k = 0 ; k <= 10000 ; k++)
+    {
+        float value = k / 10000.0f;
+        grid.set(0, value);
+        EXPECT_LE(std::fabs(grid.get(0) - value), 1.0 / 131072 + 1e-9) << "value " << value;
+    }
+
+    grid.set(0, 0);
+    EXPECT_EQ(0, grid.get(0));
+    grid.set(0, 1);
+    EXPECT_EQ(1, grid.get(0));
+}
+
+TEST(ProbabilityGrid, BFloat16RoundTripError)
+{
+    ProbabilityGrid grid (1, 1, 0, ProbabilityGrid::BFLOAT16);
+
+    for (float value = 1e-30f ; value <= 1 ; value *= 1.07f)
+    {
+        grid.set(0, value);
+        EXPECT_LE(std::fabs(grid.get(0) - value), value / 256) << "value " << value;
+    }
+
+    grid.set(0, 0);
+    EXPECT_EQ(0, grid.get(0));
+    grid.set(0, 1);
+    EXPECT_EQ(1, grid.get(0));
+}
+
+TEST(ProbabilityGrid, NormalizeKeepsUnitMass)
+{
+    ProbabilityGrid::Storage storages[3] = {ProbabilityGrid::FLOAT, ProbabilityGrid::FIXED_POINT, ProbabilityGrid::BFLOAT16};
+    // each normalized cell is stored with the round trip error above
+    double tolerances[3] = {1e-5, WIDTH * HEIGHT / 131072.0, 1.0 / 256};
+
+    for (int k = 0 ; k < 3 ; k++)
+    {
+        ProbabilityGrid grid = makeGrid(storages[k]);
+        ASSERT_TRUE(grid.normalize());
+        EXPECT_NEAR(1.0, grid.sum(), tolerances[k]) << "storage " << storages[k];
+    }
+
+    ProbabilityGrid empty_grid (WIDTH, HEIGHT, 0, ProbabilityGrid::BFLOAT16);
+    EXPECT_FALSE(empty_grid.normalize());
+}
+
+TEST(ProbabilityGrid, QuantizedArgmaxIsANearTie)
+{
+    ProbabilityGrid float_grid = makeGrid(ProbabilityGrid::FLOAT);
+    ProbabilityGrid quantized_grid (float_grid, ProbabilityGrid::BFLOAT16);
+
+    // two cells can only swap if bfloat16 rounds them to the same value or past each other
+    float max_probability = float_grid.max();
+    EXPECT_GE(float_grid.get(quantized_grid.argmax()), max_probability * (1 - 1.0 / 128));
+}
+
+TEST(ProbabilityGrid, QuantizedCopyMovesHalfTheBytes)
+{
+    ProbabilityGrid float_grid = makeGrid(ProbabilityGrid::FLOAT);
+    ProbabilityGrid quantized_grid (float_grid, ProbabilityGrid::BFLOAT16);
+
+    EXPECT_EQ(float_grid.getMemorySize(), 2 * quantized_grid.getMemorySize());
+
+    ProbabilityGrid copied_grid (quantized_grid);
+    EXPECT_EQ(ProbabilityGrid::BFLOAT16, copied_grid.getStorage());
+    EXPECT_EQ(quantized_grid.getMemorySize(), copied_grid.getMemorySize());
+
+    ProbabilityGrid assigned_grid;
+    assigned_grid = quantized_grid;
+    EXPECT_EQ(ProbabilityGrid::BFLOAT16, assigned_grid.getStorage());
+
+    for (int cell = 0 ; cell < quantized_grid.getSize() ; cell++)
+    {
+        ASSERT_EQ(quantized_grid.get(cell), copied_grid.get(cell));
+        ASSERT_EQ(quantized_grid.get(cell), assigned_grid.get(cell));
+    }
+}
+
+TEST(ProbabilityGrid, StorageConversionRoundsOnce)
+{
+    ProbabilityGrid grid = makeGrid(ProbabilityGrid::FLOAT);
+    ProbabilityGrid quantized_grid (grid, ProbabilityGrid::BFLOAT16);
+
+    grid.setStorage(ProbabilityGrid::BFLOAT16);
+    grid.setStorage(ProbabilityGrid::FLOAT);
+    EXPECT_EQ(ProbabilityGrid::FLOAT, grid.getStorage());
+
+    // decoded values are exact in float and encode back to themselves
+    grid.setStorage(ProbabilityGrid::BFLOAT16);
+    for (int cell = 0 ; cell < grid.getSize() ; cell++)
+        ASSERT_EQ(quantized_grid.get(cell), grid.get(cell));
+}
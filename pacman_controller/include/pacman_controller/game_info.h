@@ -6,6 +6,7 @@
 #include "pacman_interface/PacmanAction.h"
 #include "pacman_interface/AgentAction.h"
 #include "std_msgs/String.h"
+#include "pacman_abstract_classes/distance_matrix.h"
 
 #include <vector>
 
@@ -32,7 +33,7 @@ class GameInfo
 	std::vector< std::pair<int, int> > getLegalNextPositions(int x, int y);
 
     void precalculateAllDistances();
-    std::map< std::pair<int, int>, int > getDistances(int x, int y);
+    const DistanceMatrix& getDistanceMatrix();
 
     geometry_msgs::Pose getPacmanPose();
     std::vector< geometry_msgs::Pose > getGhostsPoses();
@@ -55,8 +56,7 @@ class GameInfo
 
     void updateAgents(const pacman_interface::AgentAction::ConstPtr& msg);
 
-    std::map< std::pair<int, int>, int > calculateDistances(int x, int y);
-    std::map< std::pair<int, int>, std::map< std::pair<int, int>, int > > precalculated_distances_;
+    DistanceMatrix distance_matrix_;
 };
 
 #endif // GAME_H
\ No newline at end of file
@@ -83,7 +83,8 @@ pacman_interface::PacmanAction BehaviorKeyboardAgent::getHuntAction(GameInfo gam
     GameInfo game_info_ = game_info;
 
     geometry_msgs::Pose pacman_pose = game_info_.getPacmanPose();
-    std::map< std::pair<int, int>, int > distances = game_info_.getDistances(pacman_pose.position.x, pacman_pose.position.y);
+    const DistanceMatrix& distance_matrix = game_info_.getDistanceMatrix();
+    const uint16_t *distances = distance_matrix.getDistanceRow(pacman_pose.position.x, pacman_pose.position.y);
 
     int min_distance = util::MAX_DISTANCE;
     game_info.printMap();
@@ -93,7 +94,7 @@ pacman_interface::PacmanAction BehaviorKeyboardAgent::getHuntAction(GameInfo gam
         ROS_INFO_STREAM("Ghost size: " << ghosts_poses.size() << " num: " << game_info_.getNumberOfGhosts(););  
     for(std::vector< geometry_msgs::Pose >::reverse_iterator it = ghosts_poses.rbegin(); it != ghosts_poses.rend(); ++it) {
         /* std::cout << *it; ... */
-        int distance = distances[std::make_pair(it->position.x, it->position.y)];
+        int distance = distance_matrix.distance(distances, it->position.x, it->position.y);
         ROS_INFO_STREAM("Ghost x: " << it->position.x << " y: " << it->position.y );    
         if(distance != 0 && distance < min_distance)
         {
@@ -110,15 +111,15 @@ pacman_interface::PacmanAction BehaviorKeyboardAgent::getHuntAction(GameInfo gam
 
     ROS_INFO_STREAM("x: " << closest_ghost->position.x << " y: " << closest_ghost->position.y );
 
-    distances = game_info_.getDistances(closest_ghost->position.x, closest_ghost->position.y);
+    distances = distance_matrix.getDistanceRow(closest_ghost->position.x, closest_ghost->position.y);
     std::vector< pacman_interface::PacmanAction > actions = game_info_.getLegalActions(pacman_pose.position.x, pacman_pose.position.y);
     std::vector< std::pair<int, int> > next_positions = game_info_.getLegalNextPositions(pacman_pose.position.x, pacman_pose.position.y);
 
     int action_iterator = 0;
     for(int i = next_positions.size() - 1; i != -1; i--)
     {
-        ROS_INFO_STREAM("- distance " << (short) actions[i].action << " : " << distances[ next_positions[i] ] );
-        if ( distances[ next_positions[i] ] < min_distance )
+        ROS_INFO_STREAM("- distance " << (short) actions[i].action << " : " << distance_matrix.distance(distances, next_positions[i].first, next_positions[i].second) );
+        if ( distance_matrix.distance(distances, next_positions[i].first, next_positions[i].second) < min_distance )
         {
             action_iterator = i;
             break;
@@ -133,7 +134,8 @@ pacman_interface::PacmanAction BehaviorKeyboardAgent::getRunAction(GameInfo game
     GameInfo game_info_ = game_info;
 
     geometry_msgs::Pose pacman_pose = game_info_.getPacmanPose();
-    std::map< std::pair<int, int>, int > distances = game_info_.getDistances(pacman_pose.position.x, pacman_pose.position.y);
+    const DistanceMatrix& distance_matrix = game_info_.getDistanceMatrix();
+    const uint16_t *distances = distance_matrix.getDistanceRow(pacman_pose.position.x, pacman_pose.position.y);
 
     int min_distance = util::MAX_DISTANCE;
 
@@ -141,7 +143,7 @@ pacman_interface::PacmanAction BehaviorKeyboardAgent::getRunAction(GameInfo game
     std::vector< geometry_msgs::Pose >::reverse_iterator closest_ghost;
     for(std::vector< geometry_msgs::Pose >::reverse_iterator it = ghosts_poses.rbegin(); it != ghosts_poses.rend(); ++it) {
         /* std::cout << *it; ... */
-        int distance = distances[std::make_pair(it->position.x, it->position.y)];
+        int distance = distance_matrix.distance(distances, it->position.x, it->position.y);
         if(distance != 0 && distance < min_distance)
         {
             closest_ghost = it;
@@ -152,15 +154,15 @@ pacman_interface::PacmanAction BehaviorKeyboardAgent::getRunAction(GameInfo game
     game_info.printMap();
     ROS_INFO_STREAM("x: " << closest_ghost->position.x << " y: " << closest_ghost->position.y );
 
-    distances = game_info_.getDistances(closest_ghost->position.x, closest_ghost->position.y);
+    distances = distance_matrix.getDistanceRow(closest_ghost->position.x, closest_ghost->position.y);
     std::vector< pacman_interface::PacmanAction > actions = game_info_.getLegalActions(pacman_pose.position.x, pacman_pose.position.y);
     std::vector< std::pair<int, int> > next_positions = game_info_.getLegalNextPositions(pacman_pose.position.x, pacman_pose.position.y);
 
     int action_iterator = 0;
     for(int i = next_positions.size() - 1; i != -1; i--)
     {
-        ROS_INFO_STREAM("- distance " << (short) actions[i].action << " : " << distances[ next_positions[i] ] );
-        if ( distances[ next_positions[i] ] > min_distance )
+        ROS_INFO_STREAM("- distance " << (short) actions[i].action << " : " << distance_matrix.distance(distances, next_positions[i].first, next_positions[i].second) );
+        if ( distance_matrix.distance(distances, next_positions[i].first, next_positions[i].second) > min_distance )
         {
             action_iterator = i;
             break;
@@ -175,7 +177,8 @@ pacman_interface::PacmanAction BehaviorKeyboardAgent::getEatBigFoodAction(GameIn
     GameInfo game_info_ = game_info;
 
     geometry_msgs::Pose pacman_pose = game_info_.getPacmanPose();
-    std::map< std::pair<int, int>, int > distances = game_info_.getDistances(pacman_pose.position.x, pacman_pose.position.y);
+    const DistanceMatrix& distance_matrix = game_info_.getDistanceMatrix();
+    const uint16_t *distances = distance_matrix.getDistanceRow(pacman_pose.position.x, pacman_pose.position.y);
 
     int width = game_info_.getWidth();
     int height = game_info_.getHeight();
@@ -189,7 +192,7 @@ pacman_interface::PacmanAction BehaviorKeyboardAgent::getEatBigFoodAction(GameIn
         {
             if( game_info_.getMapElement(i, j) == GameInfo::BIG_FOOD)
             {
-                int distance = distances[std::make_pair(i, j)];
+                int distance = distance_matrix.distance(distances, i, j);
                 if(distance < min_distance)
                 {
                     food_x = i;
@@ -200,14 +203,14 @@ pacman_interface::PacmanAction BehaviorKeyboardAgent::getEatBigFoodAction(GameIn
         }
     }
 
-    distances = game_info_.getDistances(food_x, food_y);
+    distances = distance_matrix.getDistanceRow(food_x, food_y);
     std::vector< pacman_interface::PacmanAction > actions = game_info_.getLegalActions(pacman_pose.position.x, pacman_pose.position.y);
     std::vector< std::pair<int, int> > next_positions = game_info_.getLegalNextPositions(pacman_pose.position.x, pacman_pose.position.y);
 
     int action_iterator = 0;
     for(int i = next_positions.size() - 1; i != -1; i--)
     {
-        if ( distances[ next_positions[i] ] < min_distance )
+        if ( distance_matrix.distance(distances, next_positions[i].first, next_positions[i].second) < min_distance )
         {
             action_iterator = i;
             break;
@@ -222,7 +225,8 @@ pacman_interface::PacmanAction BehaviorKeyboardAgent::getEatAction(GameInfo game
     GameInfo game_info_ = game_info;
 
     geometry_msgs::Pose pacman_pose = game_info_.getPacmanPose();
-    std::map< std::pair<int, int>, int > distances = game_info_.getDistances(pacman_pose.position.x, pacman_pose.position.y);
+    const DistanceMatrix& distance_matrix = game_info_.getDistanceMatrix();
+    const uint16_t *distances = distance_matrix.getDistanceRow(pacman_pose.position.x, pacman_pose.position.y);
 
     int width = game_info_.getWidth();
     int height = game_info_.getHeight();
@@ -236,7 +240,7 @@ pacman_interface::PacmanAction BehaviorKeyboardAgent::getEatAction(GameInfo game
         {
             if( game_info_.getMapElement(i, j) == GameInfo::FOOD)
             {
-                int distance = distances[std::make_pair(i, j)];
+                int distance = distance_matrix.distance(distances, i, j);
                 if(distance < min_distance)
                 {
                     food_x = i;
@@ -247,14 +251,14 @@ pacman_interface::PacmanAction BehaviorKeyboardAgent::getEatAction(GameInfo game
         }
     }
 
-    distances = game_info_.getDistances(food_x, food_y);
+    distances = distance_matrix.getDistanceRow(food_x, food_y);
     std::vector< pacman_interface::PacmanAction > actions = game_info_.getLegalActions(pacman_pose.position.x, pacman_pose.position.y);
     std::vector< std::pair<int, int> > next_positions = game_info_.getLegalNextPositions(pacman_pose.position.x, pacman_pose.position.y);
 
     int action_iterator = 0;
     for(int i = next_positions.size() - 1; i != -1; i--)
     {
-        if ( distances[ next_positions[i] ] < min_distance )
+        if ( distance_matrix.distance(distances, next_positions[i].first, next_positions[i].second) < min_distance )
         {
             action_iterator = i;
             break;
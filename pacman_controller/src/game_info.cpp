@@ -191,64 +191,24 @@ std::vector< std::pair<int, int> > GameInfo::getLegalNextPositions(int x, int y)
     return legal_next_positions;
 }
 
-std::map< std::pair<int, int>, int > GameInfo::calculateDistances(int x, int y)
-{
-    std::map< std::pair<int, int>, int > distances;
-
-    distances[std::make_pair(x, y)] = 0;
-
-    int current_distance = 0;
-    bool done = false;
-
-    std::vector< std::pair<int, int> > legal_positions = getLegalNextPositions(x, y);
-
-    while(!done)
-    {
-        done = true;
-        current_distance++;
-        std::vector< std::pair<int, int> > next_legal_positions;
-
-        for(std::vector< std::pair<int, int> >::reverse_iterator it = legal_positions.rbegin(); it != legal_positions.rend(); ++it)
-        {
-            if ( distances.find(*it) == distances.end() )
-            {
-                distances[*it] = current_distance;
-                done = false;
-
-                std::vector< std::pair<int, int> > temp_legal_positions = getLegalNextPositions(it->first, it->second);
-                next_legal_positions.reserve(next_legal_positions.size() + temp_legal_positions.size());
-                next_legal_positions.insert(next_legal_positions.end(), temp_legal_positions.begin(), temp_legal_positions.end());
-            }
-        }
-
-        legal_positions = next_legal_positions;
-    }
-    
-    return distances;
-}
-
 void GameInfo::precalculateAllDistances() {
     ROS_INFO_STREAM("Calculating all distances");
 
-    for (int i = 0 ; i < width_ ; i++)
+    std::vector<bool> open_cells (width_ * height_, false);
+    for (int j = 0 ; j < height_ ; j++)
     {
-        for (int j = 0 ; j < height_ ; j++)
-        {
-            if( map_[j][i] != WALL)
-            {
-                precalculated_distances_[std::make_pair(i, j)] = calculateDistances(i, j);
-            }
-        }
+        for (int i = 0 ; i < width_ ; i++)
+            open_cells[j * width_ + i] = map_[j][i] != WALL;
     }
 
+    distance_matrix_ = DistanceMatrix(width_, height_, open_cells, DistanceMatrix::getDefaultCacheDirectory());
+
     ROS_INFO_STREAM("Pre calculated all distances");
 }
 
-std::map< std::pair<int, int>, int > GameInfo::getDistances(int x, int y)
+const DistanceMatrix& GameInfo::getDistanceMatrix()
 {
-    std::map< std::pair<int, int>, int > distances = precalculated_distances_[std::make_pair(x, y)];
-    
-    return distances;
+    return distance_matrix_;
 }
 
 geometry_msgs::Pose GameInfo::getPacmanPose()
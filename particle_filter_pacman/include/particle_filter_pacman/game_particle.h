@@ -63,8 +63,6 @@ class GameParticle
     void movePacman(pacman_interface::PacmanAction action);
     void moveGhost(std::vector< geometry_msgs::Pose >::reverse_iterator it);
     void moveGhosts();
-
-    static bool particle_initialized;
 };
 
 #endif // GAME_PARTICLE_H
\ No newline at end of file
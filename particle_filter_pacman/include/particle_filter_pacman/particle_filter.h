@@ -5,21 +5,40 @@
 #include <vector>
 
 #include "particle_filter_pacman/game_particle.h"
+#include "particle_filter_pacman/particle_layout.h"
+#include "particle_filter_pacman/particle_store.h"
+#include "particle_filter_pacman/particle_resampler.h"
 #include "pacman_interface/PacmanAction.h"
 #include "pacman_interface/AgentPose.h"
 #include "geometry_msgs/Pose.h"
+#include "pacman_abstract_classes/distance_matrix.h"
+#include "pacman_abstract_classes/likelihood_table.h"
+#include "pacman_abstract_classes/random_stream.h"
+#include "pacman_abstract_classes/task_scheduler.h"
 
 /**
- * Class that implements a particle filter on the pacman game.
+ * Class that implements a particle filter on the pacman game. Particles are moved and weighted
+ * in parallel over fixed blocks, each drawing from its own random stream, so a match seed gives
+ * the same particles whatever the number of threads.
  * 
  * @author Tiago Pimentel Martins da Silva
  */
 class ParticleFilter
 {
   public:
-    ParticleFilter();
+    // 0 particles uses util::NUMBER_OF_PARTICLES, 0 threads one per core
+    ParticleFilter(int num_particles = 0, int num_threads = 0);
 
     void estimateMovement(pacman_interface::PacmanAction action);
+    // observes pacman and every ghost (offsets to pacman, in ghost order) of a tick with a single resampling
+    void observeAgents(const geometry_msgs::Pose& pacman_measurement, const std::vector< geometry_msgs::Pose >& ghosts_measurements);
+
+    // systematic by default
+    void setResamplingMethod(ParticleResampler::Method method);
+    // restarts the filter's random numbers from the current match seed
+    void reseed();
+
+    int getNumberOfParticles();
 
     void printPacmanParticles();
     void printGhostParticles(int ghost_index);
@@ -37,7 +56,7 @@ class ParticleFilter
     std::vector< geometry_msgs::Pose > getEstimatedGhostsPoses();
     double getEstimatedScore();
     double getEstimatedReward();
-    std::map< std::pair<int, int>, int > getDistances(int x, int y);
+    const DistanceMatrix& getDistanceMatrix();
     
     std::vector< pacman_interface::PacmanAction > getLegalActions(int x, int y);
     std::vector< std::pair<int, int> > getLegalNextPositions(int x, int y);
@@ -46,13 +65,14 @@ class ParticleFilter
     ros::NodeHandle n_;
     ros::Subscriber ghost_distance_subscriber_;
     ros::Subscriber pacman_pose_subscriber_;
-    std::vector< GameParticle > game_particles_;
+    // walls, spawns and moves are kept once in layout_, each particle only has its own poses, timers, score and food
+    ParticleLayout layout_;
+    ParticleStore particles_;
     bool is_observed_;
 
     int map_height_;
     int map_width_;
     int num_ghosts_;
-    std::vector< std::vector<bool> > walls_;
     double score_;
     double last_reward_;
 
@@ -60,15 +80,33 @@ class ParticleFilter
     geometry_msgs::Pose estimated_pacman_pose_;
     std::vector< geometry_msgs::Pose > estimated_ghosts_poses_;
 
-    void sampleParticles(std::map< double, GameParticle > particles_map, double sum_prob_all_particles);
+    // weight of each particle in the current observation, filled by the observe functions
+    std::vector<double> weights_;
+    std::vector<int> parents_;
+    ParticleResampler resampler_;
+    // resampling draws from the filter's own stream and moves from the stream of their block, so a match seed replays the same particles
+    RandomStream random_;
+    std::vector<RandomStream> block_randoms_;
+    // false if every particle has zero weight, in which case they are kept
+    bool resampleParticles();
+
+    TaskScheduler task_scheduler_;
+    void moveBlocks(pacman_interface::PacmanAction action, int begin_block, int end_block);
+    void weighPacmanParticles(int measurement_x, int measurement_y, int begin, int end);
+    void weighGhostParticles(int ghost_index, int measurement_x, int measurement_y, int begin, int end);
+    void weighAgentsParticles(const geometry_msgs::Pose *pacman_measurement, const std::vector< geometry_msgs::Pose > *ghosts_measurements,
+                                int begin, int end);
     void observePacman(const geometry_msgs::Pose::ConstPtr& msg);
     void observeGhost(const pacman_interface::AgentPose::ConstPtr& msg);
 
     void printPacmanOrGhostParticles(bool is_pacman, int ghost_index);
 
-    std::map< std::pair<int, int>, std::map< std::pair<int, int>, int > > precalculated_distances_;
-    std::map< std::pair<int, int>, int > calculateDistances(int x, int y);
+    DistanceMatrix distance_matrix_;
     void precalculateAllDistances();
+
+    // measurement models of the pacman pose and of the ghost distances to pacman
+    const LikelihoodTable *pacman_likelihood_table_;
+    const LikelihoodTable *ghost_distance_likelihood_table_;
 };
 
 #endif // PARTICLE_FILTER_H
\ No newline at end of file
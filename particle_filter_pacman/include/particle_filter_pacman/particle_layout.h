@@ -0,0 +1,70 @@
+#ifndef PARTICLE_LAYOUT_H
+#define PARTICLE_LAYOUT_H
+
+#include "particle_filter_pacman/game_particle.h"
+#include "pacman_interface/PacmanAction.h"
+
+#include <vector>
+
+/**
+ * Class that holds what every particle of a game shares: walls, the initial food, the pacman
+ * start and ghost spawn cells and, for each open cell, the cells pacman and the ghosts can move
+ * to. It is read once from a GameParticle, so particles only keep what changes during a game.
+ * Cells are y * width + x and open cells are also numbered in that order.
+ *
+ * @author Tiago Pimentel Martins da Silva
+ */
+class ParticleLayout
+{
+  public:
+    // pacman moves, in the order GameParticle lists them
+    enum Direction {NORTH, SOUTH, WEST, EAST, NUM_DIRECTIONS};
+
+    ParticleLayout();
+    ParticleLayout(GameParticle& game_particle);
+    ~ParticleLayout();
+
+    int getWidth() const;
+    int getHeight() const;
+    int getNumberOfGhosts() const;
+    int getNumberOfOpenCells() const;
+
+    int getCell(int x, int y) const;
+    bool isWall(int x, int y) const;
+    // -1 for walls
+    int getOpenCellIndex(int cell) const;
+    int getOpenCell(int open_cell_index) const;
+    GameParticle::MapElements getInitialElement(int cell) const;
+
+    int getPacmanStartCell() const;
+    int getGhostSpawnCell(int ghost_index) const;
+
+    // cell pacman ends in when moving in direction from cell, -1 if there is a wall
+    int getPacmanMove(int cell, Direction direction) const;
+    // cells a ghost can move to, in the order GameParticle picks them
+    int getNumberOfGhostMoves(int cell) const;
+    const int *getGhostMoves(int cell) const;
+
+    std::vector< pacman_interface::PacmanAction > getLegalActions(int x, int y) const;
+    std::vector< std::pair<int, int> > getLegalNextPositions(int x, int y) const;
+
+  protected:
+    int width_;
+    int height_;
+    int num_ghosts_;
+
+    std::vector<bool> walls_;
+    std::vector<int> open_cell_indexes_;
+    std::vector<int> open_cells_;
+    std::vector<GameParticle::MapElements> initial_elements_;
+
+    int pacman_start_cell_;
+    std::vector<int> ghosts_spawn_cells_;
+
+    std::vector<int> pacman_moves_;
+    // ghost moves of cell are ghost_moves_[ghost_moves_offsets_[cell]] to ghost_moves_[ghost_moves_offsets_[cell + 1]]
+    std::vector<int> ghost_moves_offsets_;
+    std::vector<int> ghost_moves_;
+};
+
+#endif // PARTICLE_LAYOUT_H
@@ -0,0 +1,45 @@
+#ifndef PARTICLE_RESAMPLER_H
+#define PARTICLE_RESAMPLER_H
+
+#include "pacman_abstract_classes/random_stream.h"
+
+#include <vector>
+
+/**
+ * Class that draws the parents of a new generation of particles from their weights. Every
+ * method walks the cumulative weights once against sorted sample points, so resampling is O(N),
+ * and returns parent indexes in ascending order for the particle store to gather. Systematic
+ * uses one random offset for all points, stratified one per point, multinomial sorted uniform
+ * points and residual keeps floor(N * weight) copies of each particle before drawing the rest
+ * multinomially.
+ *
+ * @author Tiago Pimentel Martins da Silva
+ */
+class ParticleResampler
+{
+  public:
+    typedef enum {MULTINOMIAL, SYSTEMATIC, STRATIFIED, RESIDUAL} Method;
+
+    ParticleResampler(Method method = SYSTEMATIC);
+    ~ParticleResampler();
+
+    Method getMethod() const;
+    void setMethod(Method method);
+
+    // fills parents with num_samples indexes of weights drawn from random, false (and no parents) if all weights are 0
+    bool resample(const std::vector<double>& weights, int num_samples, std::vector<int>& parents, RandomStream& random);
+
+  protected:
+    Method method_;
+    // sample points in [0, 1), ascending
+    std::vector<double> points_;
+    std::vector<double> residual_weights_;
+
+    void generateSystematicPoints(int num_points, RandomStream& random);
+    void generateStratifiedPoints(int num_points, RandomStream& random);
+    void generateMultinomialPoints(int num_points, RandomStream& random);
+    // appends to parents the index each point falls in, weights summing to total_weight
+    void selectParents(const std::vector<double>& weights, double total_weight, std::vector<int>& parents);
+};
+
+#endif // PARTICLE_RESAMPLER_H
@@ -0,0 +1,90 @@
+#ifndef PARTICLE_STORE_H
+#define PARTICLE_STORE_H
+
+#include "particle_filter_pacman/particle_layout.h"
+#include "pacman_interface/PacmanAction.h"
+#include "pacman_abstract_classes/random_stream.h"
+
+#include <vector>
+#include <stdint.h>
+
+#include <boost/shared_ptr.hpp>
+
+/**
+ * Class that holds the particles of a particle filter as columns, one per value, with everything
+ * particles share kept once in a ParticleLayout. Ghost columns hold particle ghost_index *
+ * size() + particle, so filter steps that read a single value of every particle go through
+ * contiguous memory. Food and big food are bitsets over the open cells, shared copy on write:
+ * resampled particles point to their parent's bits until one of them can eat in its next move.
+ * Particles move exactly as a GameParticle does.
+ *
+ * @author Tiago Pimentel Martins da Silva
+ */
+class ParticleStore
+{
+  public:
+    ParticleStore();
+    // num_particles copies of a game just started in layout, which must outlive the store
+    ParticleStore(const ParticleLayout& layout, int num_particles);
+    ~ParticleStore();
+
+    int size() const;
+
+    // gives its own food bits to every particle that shares them and can eat in its next move, call it
+    // after the particles change and before moving them
+    void unshareFoodBits();
+    // same as GameParticle::move, drawing from random, different particles can be moved by different threads at once
+    void move(int particle, pacman_interface::PacmanAction action, RandomStream& random);
+    // replaces the particles by copies of parents[0], parents[1], ...
+    void resample(const std::vector<int>& parents);
+
+    const int16_t *getPacmanXs() const;
+    const int16_t *getPacmanYs() const;
+    const int16_t *getGhostXs(int ghost_index) const;
+    const int16_t *getGhostYs(int ghost_index) const;
+    const int16_t *getWhiteGhostsTimes(int ghost_index) const;
+    const int *getScores() const;
+    // one bit per open cell, in getNumberOfFoodWords() words
+    int getNumberOfFoodWords() const;
+    const uint64_t *getFoodBits(int particle) const;
+    const uint64_t *getBigFoodBits(int particle) const;
+    bool hasFood(int particle, int open_cell_index) const;
+    bool hasBigFood(int particle, int open_cell_index) const;
+
+  protected:
+    const ParticleLayout *layout_;
+    int num_particles_;
+    int num_ghosts_;
+    int num_open_cells_;
+
+    std::vector<int16_t> pacman_xs_;
+    std::vector<int16_t> pacman_ys_;
+    std::vector<int16_t> ghosts_xs_;
+    std::vector<int16_t> ghosts_ys_;
+    std::vector<int16_t> white_ghosts_times_;
+    std::vector<int> scores_;
+
+    // food bits followed by big food bits, shared by all particles descending from the last one that ate
+    typedef boost::shared_ptr< std::vector<uint64_t> > FoodBits;
+    int num_food_words_;
+    std::vector< FoodBits > foods_;
+    // food bits of particle to be changed, only particle holds them after unshareFoodBits
+    std::vector<uint64_t>& getOwnFoodBits(int particle);
+    bool hasAnyFood(int particle, int open_cell_index) const;
+
+    // columns being resampled into, swapped with the ones above
+    std::vector<int16_t> new_values_;
+    std::vector<int> new_scores_;
+    std::vector< FoodBits > new_foods_;
+
+    void movePacman(int particle, pacman_interface::PacmanAction action, RandomStream& random);
+    void moveGhost(int particle, int ghost_index, RandomStream& random);
+    void moveGhosts(int particle, RandomStream& random);
+    void checkIfDeadGhosts(int particle);
+    bool isWithPacman(int particle, int ghost_index) const;
+    void sendToSpawn(int particle, int ghost_index);
+
+    void resampleColumn(std::vector<int16_t>& column, int num_rows, const std::vector<int>& parents);
+};
+
+#endif // PARTICLE_STORE_H
@@ -4,6 +4,8 @@ namespace util
     extern const float PRINT_FOOD_MINIMUM;
 
     extern const int NUMBER_OF_PARTICLES;
+    // particles moved with one random stream, and the least handed to a thread
+    extern const int PARTICLES_PER_BLOCK;
     extern const float CHANCE_OF_ACTION_SUCCESS;
 
     extern const float DIFF_NUMBER_OF_GHOST_MOVES;
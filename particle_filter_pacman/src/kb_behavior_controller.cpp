@@ -2,6 +2,10 @@
 
 #include "particle_filter_pacman/particle_filter.h"
 #include "particle_filter_pacman/behavior_keyboard_agent.h"
+#include "pacman_abstract_classes/random_stream.h"
+
+// seed of the match, 0 takes it from the clock
+uint64_t RANDOM_SEED = 0;
 
 int main(int argc, char **argv)
 {
@@ -12,6 +16,12 @@ int main(int argc, char **argv)
     BehaviorKeyboardAgent pacman_agent;
     ParticleFilter particle_filter;
 
+    if (!RANDOM_SEED)
+        RANDOM_SEED = time(NULL);
+    RandomStream::setMatchSeed(RANDOM_SEED);
+    // the filter drew its streams from the clock when it was built
+    particle_filter.reseed();
+
     int loop_count = 0;
 
     while (ros::ok())
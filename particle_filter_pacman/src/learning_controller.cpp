@@ -3,6 +3,10 @@
 #include "particle_filter_pacman/particle_filter.h"
 #include "particle_filter_pacman/learning_agent.h"
 #include "particle_filter_pacman/q_learning_simple.h"
+#include "pacman_abstract_classes/random_stream.h"
+
+// seed of the match, 0 takes it from the clock
+uint64_t RANDOM_SEED = 0;
 
 int main(int argc, char **argv)
 {
@@ -14,6 +18,12 @@ int main(int argc, char **argv)
     ParticleFilter particle_filter;
     QLearningSimple q_learning;
 
+    if (!RANDOM_SEED)
+        RANDOM_SEED = time(NULL);
+    RandomStream::setMatchSeed(RANDOM_SEED);
+    // the filter drew its streams from the clock when it was built
+    particle_filter.reseed();
+
     int loop_count = 0;
 
     while (ros::ok())
@@ -0,0 +1,83 @@
+#include "ros/ros.h"
+
+#include "particle_filter_pacman/particle_filter.h"
+#include "particle_filter_pacman/game_particle.h"
+#include "pacman_abstract_classes/random_stream.h"
+
+#include <boost/thread.hpp>
+#include <algorithm>
+
+int NUMBERS_OF_PARTICLES[] = {1000, 3000, 10000, 30000, 100000};
+int NUMBER_OF_TICKS = 50;
+// every run replays the same match, so runs of a size must end with the same estimate
+uint64_t RANDOM_SEED = 42;
+
+// moves and observes every particle of a filter for NUMBER_OF_TICKS ticks of a simulated match, returns particles per second
+double runFilter(int num_particles, int num_threads, double *estimated_score)
+{
+    RandomStream::setMatchSeed(RANDOM_SEED);
+    ParticleFilter particle_filter(num_particles, num_threads);
+    // the match being filtered, moved as particles are
+    GameParticle game;
+    RandomStream& random = RandomStream::getThreadStream();
+
+    double elapsed_time = 0;
+    for (int tick = 0 ; tick < NUMBER_OF_TICKS ; tick++)
+    {
+        geometry_msgs::Pose pacman_pose = game.getPacmanPose();
+        std::vector< pacman_interface::PacmanAction > legal_actions = game.getLegalActions(pacman_pose.position.x, pacman_pose.position.y);
+        pacman_interface::PacmanAction action = legal_actions[random.getInt(legal_actions.size())];
+        game.move(action);
+
+        // ghosts are measured by their offset to pacman
+        pacman_pose = game.getPacmanPose();
+        std::vector< geometry_msgs::Pose > ghosts_measurements = game.getGhostsPoses();
+        for (std::vector< geometry_msgs::Pose >::iterator it = ghosts_measurements.begin(); it != ghosts_measurements.end(); ++it)
+        {
+            it->position.x -= pacman_pose.position.x;
+            it->position.y -= pacman_pose.position.y;
+        }
+
+        ros::WallTime start_time = ros::WallTime::now();
+        particle_filter.estimateMovement(action);
+        particle_filter.observeAgents(pacman_pose, ghosts_measurements);
+        elapsed_time += (ros::WallTime::now() - start_time).toSec();
+    }
+
+    particle_filter.estimateMap();
+    *estimated_score = particle_filter.getEstimatedScore();
+
+    return num_particles * (double) NUMBER_OF_TICKS / elapsed_time;
+}
+
+int main(int argc, char **argv)
+{
+    ros::init(argc, argv, "particle_filter_benchmark");
+    ros::NodeHandle n;
+
+    // 1, 2, 4, ... threads, and every core
+    int max_threads = boost::thread::hardware_concurrency();
+    std::vector<int> numbers_of_threads;
+    for (int num_threads = 1 ; num_threads < max_threads ; num_threads *= 2)
+        numbers_of_threads.push_back(num_threads);
+    numbers_of_threads.push_back(std::max(max_threads, 1));
+
+    int num_sizes = sizeof(NUMBERS_OF_PARTICLES) / sizeof(NUMBERS_OF_PARTICLES[0]);
+    for (int size = 0 ; size < num_sizes && ros::ok() ; size++)
+    {
+        double serial_rate = 0;
+
+        for (std::vector<int>::iterator it = numbers_of_threads.begin(); it != numbers_of_threads.end() && ros::ok(); ++it)
+        {
+            double estimated_score;
+            double rate = runFilter(NUMBERS_OF_PARTICLES[size], *it, &estimated_score);
+            if (*it == 1)
+                serial_rate = rate;
+
+            ROS_INFO_STREAM(NUMBERS_OF_PARTICLES[size] << " particles, " << *it << " threads: " << rate << " particles/s, speedup "
+                                << rate / serial_rate << ", estimated score " << estimated_score);
+        }
+    }
+
+    return 0;
+}
@@ -91,7 +91,8 @@ pacman_interface::PacmanAction BehaviorKeyboardAgent::getRunAction(ParticleFilte
     pacman_interface::PacmanAction action;
 
     geometry_msgs::Pose pacman_pose = particle_filter->getEstimatedPacmanPose();
-    std::map< std::pair<int, int>, int > distances = particle_filter->getDistances(pacman_pose.position.x, pacman_pose.position.y);
+    const DistanceMatrix& distance_matrix = particle_filter->getDistanceMatrix();
+    const uint16_t *distances = distance_matrix.getDistanceRow(pacman_pose.position.x, pacman_pose.position.y);
 
     int min_distance = util::MAX_DISTANCE;
 
@@ -99,7 +100,7 @@ pacman_interface::PacmanAction BehaviorKeyboardAgent::getRunAction(ParticleFilte
     std::vector< geometry_msgs::Pose >::reverse_iterator closest_ghost;
     for(std::vector< geometry_msgs::Pose >::reverse_iterator it = ghosts_poses.rbegin(); it != ghosts_poses.rend(); ++it) {
         /* std::cout << *it; ... */
-        int distance = distances[std::make_pair(it->position.x, it->position.y)];
+        int distance = distance_matrix.distance(distances, it->position.x, it->position.y);
         if(distance != 0 && distance < min_distance)
         {
             closest_ghost = it;
@@ -110,15 +111,15 @@ pacman_interface::PacmanAction BehaviorKeyboardAgent::getRunAction(ParticleFilte
   //  game_info.printMap();
     ROS_INFO_STREAM("x: " << closest_ghost->position.x << " y: " << closest_ghost->position.y );
 
-    distances = particle_filter->getDistances(closest_ghost->position.x, closest_ghost->position.y);
+    distances = distance_matrix.getDistanceRow(closest_ghost->position.x, closest_ghost->position.y);
     std::vector< pacman_interface::PacmanAction > actions = particle_filter->getLegalActions(pacman_pose.position.x, pacman_pose.position.y);
     std::vector< std::pair<int, int> > next_positions = particle_filter->getLegalNextPositions(pacman_pose.position.x, pacman_pose.position.y);
 
     int action_iterator = -1;
     for(int i = next_positions.size() - 1; i != -1; i--)
     {
-        ROS_INFO_STREAM("- distance " << (short) actions[i].action << " : " << distances[ next_positions[i] ] );
-        if ( distances[ next_positions[i] ] > min_distance )
+        ROS_INFO_STREAM("- distance " << (short) actions[i].action << " : " << distance_matrix.distance(distances, next_positions[i].first, next_positions[i].second) );
+        if ( distance_matrix.distance(distances, next_positions[i].first, next_positions[i].second) > min_distance )
         {
             action_iterator = i;
             break;
@@ -140,7 +141,8 @@ pacman_interface::PacmanAction BehaviorKeyboardAgent::getEatBigFoodAction(Partic
     pacman_interface::PacmanAction action;
 
     geometry_msgs::Pose pacman_pose = particle_filter->getEstimatedPacmanPose();
-    std::map< std::pair<int, int>, int > distances = particle_filter->getDistances(pacman_pose.position.x, pacman_pose.position.y);
+    const DistanceMatrix& distance_matrix = particle_filter->getDistanceMatrix();
+    const uint16_t *distances = distance_matrix.getDistanceRow(pacman_pose.position.x, pacman_pose.position.y);
 
     int width = particle_filter->getMapWidth();
     int height = particle_filter->getMapHeight();
@@ -155,7 +157,7 @@ pacman_interface::PacmanAction BehaviorKeyboardAgent::getEatBigFoodAction(Partic
         {
             if( map[j][i] == GameParticle::BIG_FOOD)
             {
-                int distance = distances[std::make_pair(i, j)];
+                int distance = distance_matrix.distance(distances, i, j);
                 if(distance < min_distance)
                 {
                     food_x = i;
@@ -166,7 +168,7 @@ pacman_interface::PacmanAction BehaviorKeyboardAgent::getEatBigFoodAction(Partic
         }
     }
 
-    distances = particle_filter->getDistances(food_x, food_y);
+    distances = distance_matrix.getDistanceRow(food_x, food_y);
 
     std::vector< pacman_interface::PacmanAction > actions = particle_filter->getLegalActions(pacman_pose.position.x, pacman_pose.position.y);
     std::vector< std::pair<int, int> > next_positions = particle_filter->getLegalNextPositions(pacman_pose.position.x, pacman_pose.position.y);
@@ -174,7 +176,7 @@ pacman_interface::PacmanAction BehaviorKeyboardAgent::getEatBigFoodAction(Partic
     int action_iterator = 0;
     for(int i = next_positions.size() - 1; i != -1; i--)
     {
-        if ( distances[ next_positions[i] ] < min_distance )
+        if ( distance_matrix.distance(distances, next_positions[i].first, next_positions[i].second) < min_distance )
         {
             action_iterator = i;
             break;
@@ -188,7 +190,8 @@ pacman_interface::PacmanAction BehaviorKeyboardAgent::getEatAction(ParticleFilte
     pacman_interface::PacmanAction action;
 
     geometry_msgs::Pose pacman_pose = particle_filter->getEstimatedPacmanPose();
-    std::map< std::pair<int, int>, int > distances = particle_filter->getDistances(pacman_pose.position.x, pacman_pose.position.y);
+    const DistanceMatrix& distance_matrix = particle_filter->getDistanceMatrix();
+    const uint16_t *distances = distance_matrix.getDistanceRow(pacman_pose.position.x, pacman_pose.position.y);
 
     int width = particle_filter->getMapWidth();
     int height = particle_filter->getMapHeight();
@@ -203,7 +206,7 @@ pacman_interface::PacmanAction BehaviorKeyboardAgent::getEatAction(ParticleFilte
         {
             if( map[j][i] == GameParticle::FOOD)
             {
-                int distance = distances[std::make_pair(i, j)];
+                int distance = distance_matrix.distance(distances, i, j);
                 if(distance < min_distance)
                 {
                     food_x = i;
@@ -214,7 +217,7 @@ pacman_interface::PacmanAction BehaviorKeyboardAgent::getEatAction(ParticleFilte
         }
     }
 
-    distances = particle_filter->getDistances(food_x, food_y);
+    distances = distance_matrix.getDistanceRow(food_x, food_y);
     // TODO: add last part
 
     std::vector< pacman_interface::PacmanAction > actions = particle_filter->getLegalActions(pacman_pose.position.x, pacman_pose.position.y);
@@ -223,7 +226,7 @@ pacman_interface::PacmanAction BehaviorKeyboardAgent::getEatAction(ParticleFilte
     int action_iterator = 0;
     for(int i = next_positions.size() - 1; i != -1; i--)
     {
-        if ( distances[ next_positions[i] ] < min_distance )
+        if ( distance_matrix.distance(distances, next_positions[i].first, next_positions[i].second) < min_distance )
         {
             action_iterator = i;
             break;
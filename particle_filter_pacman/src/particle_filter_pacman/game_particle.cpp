@@ -3,21 +3,14 @@
 #include <sstream>
 
 #include "particle_filter_pacman/util_constants.h"
+#include "pacman_abstract_classes/random_stream.h"
 
 #include "pacman_interface/PacmanAction.h"
 #include "pacman_interface/AgentAction.h"
 #include "pacman_interface/PacmanMapInfo.h"
 
-bool GameParticle::particle_initialized = false;
-
 GameParticle::GameParticle()
 {
-    if(!particle_initialized)
-    {
-        std::srand(std::time(NULL));
-        particle_initialized = true;
-    }
-
     ros::ServiceClient initInfoClient = n_.serviceClient<pacman_interface::PacmanMapInfo>("pacman_initialize_map_layout");
     pacman_interface::PacmanMapInfo initInfo;
 
@@ -283,7 +276,7 @@ void GameParticle::movePacman(pacman_interface::PacmanAction action)
     int y = pacman_pose_.position.y;
 
     std::vector< std::pair< float, std::pair<int, int> > > next_positions = getNextPositionsWithProbabilities(x, y, action);
-    double random_variable = std::rand() / (double) RAND_MAX;
+    double random_variable = RandomStream::getThreadStream().getUniform();
     double sum_probs = 0;
 
     for(std::vector< std::pair< float, std::pair<int, int> > >::reverse_iterator it = next_positions.rbegin(); it != next_positions.rend(); ++it)
@@ -319,7 +312,7 @@ void GameParticle::moveGhost(std::vector< geometry_msgs::Pose >::reverse_iterato
     int y = it->position.y;
 
     std::vector< std::pair<int, int> > next_positions = getLegalNextPositions(x, y);
-    int random_variable = std::rand() % next_positions.size();
+    int random_variable = RandomStream::getThreadStream().getInt(next_positions.size());
 
     it->position.x = next_positions[random_variable].first;
     it->position.y = next_positions[random_variable].second;
@@ -332,7 +325,7 @@ void GameParticle::moveGhosts()
 
     for(std::vector< geometry_msgs::Pose >::reverse_iterator it = ghosts_poses_.rbegin(); it != ghosts_poses_.rend(); ++it, ++white_it, ++spawn_pose_it)
     {
-        double random_number_of_moves = std::rand() / (double) RAND_MAX;
+        double random_number_of_moves = RandomStream::getThreadStream().getUniform();
 
         if(*white_it) // if white, change probabilities of moves
         {
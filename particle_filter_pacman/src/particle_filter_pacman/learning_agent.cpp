@@ -71,14 +71,15 @@ pacman_interface::PacmanAction LearningAgent::getRunAction(ParticleFilter *parti
     pacman_interface::PacmanAction action;
 
     geometry_msgs::Pose pacman_pose = particle_filter->getEstimatedPacmanPose();
-    std::map< std::pair<int, int>, int > distances = particle_filter->getDistances(pacman_pose.position.x, pacman_pose.position.y);
+    const DistanceMatrix& distance_matrix = particle_filter->getDistanceMatrix();
+    const uint16_t *distances = distance_matrix.getDistanceRow(pacman_pose.position.x, pacman_pose.position.y);
 
     int min_distance = util::MAX_DISTANCE;
 
     std::vector< geometry_msgs::Pose > ghosts_poses = particle_filter->getEstimatedGhostsPoses();
     std::vector< geometry_msgs::Pose >::reverse_iterator closest_ghost;
     for(std::vector< geometry_msgs::Pose >::reverse_iterator it = ghosts_poses.rbegin(); it != ghosts_poses.rend(); ++it) {
-        int distance = distances[std::make_pair(it->position.x, it->position.y)];
+        int distance = distance_matrix.distance(distances, it->position.x, it->position.y);
         if(distance != 0 && distance < min_distance)
         {
             closest_ghost = it;
@@ -88,15 +89,15 @@ pacman_interface::PacmanAction LearningAgent::getRunAction(ParticleFilter *parti
 
     ROS_INFO_STREAM("x: " << closest_ghost->position.x << " y: " << closest_ghost->position.y );
 
-    distances = particle_filter->getDistances(closest_ghost->position.x, closest_ghost->position.y);
+    distances = distance_matrix.getDistanceRow(closest_ghost->position.x, closest_ghost->position.y);
     std::vector< pacman_interface::PacmanAction > actions = particle_filter->getLegalActions(pacman_pose.position.x, pacman_pose.position.y);
     std::vector< std::pair<int, int> > next_positions = particle_filter->getLegalNextPositions(pacman_pose.position.x, pacman_pose.position.y);
 
     int action_iterator = -1;
     for(int i = next_positions.size() - 1; i != -1; i--)
     {
-        ROS_INFO_STREAM("- distance " << (short) actions[i].action << " : " << distances[ next_positions[i] ] );
-        if ( distances[ next_positions[i] ] > min_distance )
+        ROS_INFO_STREAM("- distance " << (short) actions[i].action << " : " << distance_matrix.distance(distances, next_positions[i].first, next_positions[i].second) );
+        if ( distance_matrix.distance(distances, next_positions[i].first, next_positions[i].second) > min_distance )
         {
             action_iterator = i;
             break;
@@ -118,7 +119,8 @@ pacman_interface::PacmanAction LearningAgent::getEatBigFoodAction(ParticleFilter
     pacman_interface::PacmanAction action;
 
     geometry_msgs::Pose pacman_pose = particle_filter->getEstimatedPacmanPose();
-    std::map< std::pair<int, int>, int > distances = particle_filter->getDistances(pacman_pose.position.x, pacman_pose.position.y);
+    const DistanceMatrix& distance_matrix = particle_filter->getDistanceMatrix();
+    const uint16_t *distances = distance_matrix.getDistanceRow(pacman_pose.position.x, pacman_pose.position.y);
 
     int width = particle_filter->getMapWidth();
     int height = particle_filter->getMapHeight();
@@ -133,7 +135,7 @@ pacman_interface::PacmanAction LearningAgent::getEatBigFoodAction(ParticleFilter
         {
             if( map[j][i] == GameParticle::BIG_FOOD)
             {
-                int distance = distances[std::make_pair(i, j)];
+                int distance = distance_matrix.distance(distances, i, j);
                 if(distance < min_distance)
                 {
                     food_x = i;
@@ -144,7 +146,7 @@ pacman_interface::PacmanAction LearningAgent::getEatBigFoodAction(ParticleFilter
         }
     }
 
-    distances = particle_filter->getDistances(food_x, food_y);
+    distances = distance_matrix.getDistanceRow(food_x, food_y);
 
     std::vector< pacman_interface::PacmanAction > actions = particle_filter->getLegalActions(pacman_pose.position.x, pacman_pose.position.y);
     std::vector< std::pair<int, int> > next_positions = particle_filter->getLegalNextPositions(pacman_pose.position.x, pacman_pose.position.y);
@@ -152,7 +154,7 @@ pacman_interface::PacmanAction LearningAgent::getEatBigFoodAction(ParticleFilter
     int action_iterator = 0;
     for(int i = next_positions.size() - 1; i != -1; i--)
     {
-        if ( distances[ next_positions[i] ] < min_distance )
+        if ( distance_matrix.distance(distances, next_positions[i].first, next_positions[i].second) < min_distance )
         {
             action_iterator = i;
             break;
@@ -166,7 +168,8 @@ pacman_interface::PacmanAction LearningAgent::getEatAction(ParticleFilter *parti
     pacman_interface::PacmanAction action;
 
     geometry_msgs::Pose pacman_pose = particle_filter->getEstimatedPacmanPose();
-    std::map< std::pair<int, int>, int > distances = particle_filter->getDistances(pacman_pose.position.x, pacman_pose.position.y);
+    const DistanceMatrix& distance_matrix = particle_filter->getDistanceMatrix();
+    const uint16_t *distances = distance_matrix.getDistanceRow(pacman_pose.position.x, pacman_pose.position.y);
 
     int width = particle_filter->getMapWidth();
     int height = particle_filter->getMapHeight();
@@ -181,7 +184,7 @@ pacman_interface::PacmanAction LearningAgent::getEatAction(ParticleFilter *parti
         {
             if( map[j][i] == GameParticle::FOOD)
             {
-                int distance = distances[std::make_pair(i, j)];
+                int distance = distance_matrix.distance(distances, i, j);
                 if(distance < min_distance)
                 {
                     food_x = i;
@@ -192,7 +195,7 @@ pacman_interface::PacmanAction LearningAgent::getEatAction(ParticleFilter *parti
         }
     }
 
-    distances = particle_filter->getDistances(food_x, food_y);
+    distances = distance_matrix.getDistanceRow(food_x, food_y);
 
     std::vector< pacman_interface::PacmanAction > actions = particle_filter->getLegalActions(pacman_pose.position.x, pacman_pose.position.y);
     std::vector< std::pair<int, int> > next_positions = particle_filter->getLegalNextPositions(pacman_pose.position.x, pacman_pose.position.y);
@@ -200,7 +203,7 @@ pacman_interface::PacmanAction LearningAgent::getEatAction(ParticleFilter *parti
     int action_iterator = 0;
     for(int i = next_positions.size() - 1; i != -1; i--)
     {
-        if ( distances[ next_positions[i] ] < min_distance )
+        if ( distance_matrix.distance(distances, next_positions[i].first, next_positions[i].second) < min_distance )
         {
             action_iterator = i;
             break;
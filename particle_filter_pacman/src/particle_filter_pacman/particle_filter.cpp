@@ -4,136 +4,153 @@
 #include "particle_filter_pacman/util_functions.h"
 
 #include <boost/bind.hpp>
+#include <algorithm>
 
-ParticleFilter::ParticleFilter()
+ParticleFilter::ParticleFilter(int num_particles, int num_threads) : task_scheduler_(num_threads)
 {
+    if (num_particles <= 0)
+        num_particles = util::NUMBER_OF_PARTICLES;
+
     GameParticle game_particle;
     game_particle.printMap();
-    game_particles_ = std::vector< GameParticle > (util::NUMBER_OF_PARTICLES, game_particle);
+    layout_ = ParticleLayout(game_particle);
+    particles_ = ParticleStore(layout_, num_particles);
+    block_randoms_ = std::vector<RandomStream> ( (num_particles + util::PARTICLES_PER_BLOCK - 1) / util::PARTICLES_PER_BLOCK );
 
-    map_height_ = game_particle.getHeight();
-    map_width_ = game_particle.getWidth();
-    num_ghosts_ = game_particle.getNumberOfGhosts();
+    map_height_ = layout_.getHeight();
+    map_width_ = layout_.getWidth();
+    num_ghosts_ = layout_.getNumberOfGhosts();
     score_ = 0;
+    reseed();
 
-    std::vector<bool> walls_line(map_height_, false);
-    walls_ = std::vector< std::vector<bool> > (map_width_, walls_line);
-    std::vector<GameParticle::MapElements> estimated_map_line(map_height_, GameParticle::EMPTY);
-    estimated_map_ = std::vector< std::vector<GameParticle::MapElements> > (map_width_, estimated_map_line);
+    // indexed [y][x], as the agents read it
+    std::vector<GameParticle::MapElements> estimated_map_line(map_width_, GameParticle::EMPTY);
+    estimated_map_ = std::vector< std::vector<GameParticle::MapElements> > (map_height_, estimated_map_line);
     for (int i = map_height_ -1 ; i > -1  ; i--)
     {
         for (int j = 0 ; j < map_width_ ; j++)
         {
-            if( game_particle.getMapElement(j, i) == GameParticle::WALL)
-            {
-                walls_[i][j] = true;
+            if( layout_.isWall(j, i) )
                 estimated_map_[i][j] = GameParticle::WALL;
-            }
         }
     }
 
     precalculateAllDistances();
 
+    // ghost distances are differences of two poses, so their offsets to a measurement can reach twice the map size
+    int max_offset = 2 * std::max(map_width_, map_height_);
+    pacman_likelihood_table_ = &LikelihoodTable::getTable(1, max_offset);
+    ghost_distance_likelihood_table_ = &LikelihoodTable::getTable(0.5, max_offset);
+
     ghost_distance_subscriber_ = n_.subscribe<pacman_interface::AgentPose>("/pacman_interface/ghost_distance", 20, boost::bind(&ParticleFilter::observeGhost, this, _1));
     pacman_pose_subscriber_ = n_.subscribe<geometry_msgs::Pose>("/pacman_interface/pacman_pose", 10, boost::bind(&ParticleFilter::observePacman, this, _1));
 
     is_observed_ = true;
 }
 
-void ParticleFilter::estimateMovement(pacman_interface::PacmanAction action)
+void ParticleFilter::moveBlocks(pacman_interface::PacmanAction action, int begin_block, int end_block)
 {
-    for(std::vector< GameParticle >::reverse_iterator it = game_particles_.rbegin(); it != game_particles_.rend(); ++it)
+    for (int block = begin_block ; block < end_block ; block++)
     {
-        it->move(action);
+        int end = std::min( (block + 1) * util::PARTICLES_PER_BLOCK, particles_.size() );
+        for (int particle = block * util::PARTICLES_PER_BLOCK ; particle < end ; particle++)
+            particles_.move(particle, action, block_randoms_[block]);
     }
 }
 
-void ParticleFilter::sampleParticles(std::map< double, GameParticle > particles_map, double sum_prob_all_particles)
+void ParticleFilter::estimateMovement(pacman_interface::PacmanAction action)
 {
-    // initialize and reserve memory for vector that willhold new particles
-    std::vector< GameParticle > new_particles;
-    new_particles.reserve(util::NUMBER_OF_PARTICLES);
-    // precalculate random number multiplier
-    double random_multiplier = sum_prob_all_particles / (double) RAND_MAX;
-
-    // randomly sample a new particle group from <probabilities, particles> map
-    for (int particlesCounter = util::NUMBER_OF_PARTICLES ; particlesCounter > 0 ; particlesCounter-- )
-    {
-        double random_number = std::rand() * random_multiplier;
+    // the threads only write food bits no other particle holds
+    particles_.unshareFoodBits();
 
-        std::map< double, GameParticle >::iterator itlow;
-        itlow = particles_map.lower_bound (random_number);
+    // blocks are fixed and draw from their own streams, so how they are split among threads does not change the particles
+    task_scheduler_.parallelFor(0, block_randoms_.size(), 1,
+                boost::bind(&ParticleFilter::moveBlocks, this, action, _1, _2));
+}
 
-        new_particles.push_back(itlow->second);
-    }
+void ParticleFilter::setResamplingMethod(ParticleResampler::Method method)
+{
+    resampler_.setMethod(method);
+}
 
-    // update particles
-    game_particles_.clear();
-    game_particles_ = new_particles;
+void ParticleFilter::reseed()
+{
+    random_ = RandomStream::getBlockStream(0);
+    for (int block = 0 ; block < (int) block_randoms_.size() ; block++)
+        block_randoms_[block] = RandomStream::getBlockStream(block + 1);
 }
 
-void ParticleFilter::observePacman(const geometry_msgs::Pose::ConstPtr& msg)
+int ParticleFilter::getNumberOfParticles()
 {
-    int measurement_x = msg->position.x;
-    int measurement_y = msg->position.y;
+    return particles_.size();
+}
 
-    // map relating particles to probabilities
-    std::map< double, GameParticle > particles_map;
+bool ParticleFilter::resampleParticles()
+{
+    if (!resampler_.resample(weights_, particles_.size(), parents_, random_))
+        return false;
 
-    double sum_prob_all_particles = 0;
+    // survivors are gathered by index, column by column
+    particles_.resample(parents_);
+    return true;
+}
 
-    // generate a map tying particles to their probability
-    for(std::vector< GameParticle >::iterator it = game_particles_.begin(); it != game_particles_.end(); ++it)
-    {
-        geometry_msgs::Pose pose = it->getPacmanPose();
-        double probability = util::getProbOfMeasurementGivenPosition(pose.position.x, pose.position.y, measurement_x, measurement_y, 1);
+void ParticleFilter::weighPacmanParticles(int measurement_x, int measurement_y, int begin, int end)
+{
+    const int16_t *pacman_xs = particles_.getPacmanXs();
+    const int16_t *pacman_ys = particles_.getPacmanYs();
 
-        sum_prob_all_particles += probability;
-        particles_map.insert(std::pair<double,GameParticle>(sum_prob_all_particles, *it));
-    }
+    for (int particle = begin ; particle < end ; particle++)
+        weights_[particle] = pacman_likelihood_table_->getLikelihood(measurement_x - pacman_xs[particle], measurement_y - pacman_ys[particle]);
+}
+
+void ParticleFilter::observePacman(const geometry_msgs::Pose::ConstPtr& msg)
+{
+    int measurement_x = msg->position.x;
+    int measurement_y = msg->position.y;
+
+    // weight each particle by the measurement
+    weights_.resize(particles_.size());
+    task_scheduler_.parallelFor(0, particles_.size(), util::PARTICLES_PER_BLOCK,
+                boost::bind(&ParticleFilter::weighPacmanParticles, this, measurement_x, measurement_y, _1, _2));
 
     // if no particles have probability of existing (float) show error message
-    if(sum_prob_all_particles == 0)
+    if(!resampleParticles())
         ROS_ERROR_STREAM("Error, all particles have a zero probability of being correct for pacman");
-    // else, sample new particles
-    else
-        sampleParticles(particles_map, sum_prob_all_particles);
 
     is_observed_ = true;
 }
 
-// TODO: merge all ghost position measurements to gain speed
+void ParticleFilter::weighGhostParticles(int ghost_index, int measurement_x, int measurement_y, int begin, int end)
+{
+    const int16_t *pacman_xs = particles_.getPacmanXs();
+    const int16_t *pacman_ys = particles_.getPacmanYs();
+    const int16_t *ghost_xs = particles_.getGhostXs(ghost_index);
+    const int16_t *ghost_ys = particles_.getGhostYs(ghost_index);
+
+    for (int particle = begin ; particle < end ; particle++)
+    {
+        int distance_x = ghost_xs[particle] - pacman_xs[particle];
+        int distance_y = ghost_ys[particle] - pacman_ys[particle];
+
+        weights_[particle] = ghost_distance_likelihood_table_->getLikelihood(measurement_x - distance_x, measurement_y - distance_y);
+    }
+}
+
 void ParticleFilter::observeGhost(const pacman_interface::AgentPose::ConstPtr& msg)
 {
     int ghost_index = msg->agent - 1;
     int measurement_x = msg->pose.position.x;
     int measurement_y = msg->pose.position.y;
 
-    // map relating particles to probabilities
-    std::map< double, GameParticle > particles_map;
-
-    double sum_prob_all_particles = 0;
-
-    // generate a map tying particles to their probability
-    for(std::vector< GameParticle >::iterator it = game_particles_.begin(); it != game_particles_.end(); ++it)
-    {
-        geometry_msgs::Pose ghost_pose = it->getGhostPose(ghost_index);
-        geometry_msgs::Pose pacman_pose = it->getPacmanPose();
-        geometry_msgs::Pose distance;
-        distance.position.x = ghost_pose.position.x - pacman_pose.position.x;
-        distance.position.y = ghost_pose.position.y - pacman_pose.position.y;
-
-        double probability = util::getProbOfMeasurementGivenPosition(distance.position.x, distance.position.y, measurement_x, measurement_y, 0.5);
-        sum_prob_all_particles += probability;
-        particles_map.insert(std::pair<double,GameParticle>(sum_prob_all_particles, *it));
-    }
+    // weight each particle by the measurement
+    weights_.resize(particles_.size());
+    task_scheduler_.parallelFor(0, particles_.size(), util::PARTICLES_PER_BLOCK,
+                boost::bind(&ParticleFilter::weighGhostParticles, this, ghost_index, measurement_x, measurement_y, _1, _2));
 
     // if no particles have probability of existing (float) show error message
-    if(sum_prob_all_particles == 0)
+    if(!resampleParticles())
         ROS_ERROR_STREAM("Error, all particles have a zero probability of being correct for ghost " << ghost_index);
-    // else, sample new particles
-    else
-        sampleParticles(particles_map, sum_prob_all_particles);
 
 //    is_observed_ = true;
     if(ghost_index==0)
@@ -144,51 +161,98 @@ void ParticleFilter::observeGhost(const pacman_interface::AgentPose::ConstPtr& m
     }
 }
 
+void ParticleFilter::weighAgentsParticles(const geometry_msgs::Pose *pacman_measurement, const std::vector< geometry_msgs::Pose > *ghosts_measurements,
+                                int begin, int end)
+{
+    int pacman_measurement_x = pacman_measurement->position.x;
+    int pacman_measurement_y = pacman_measurement->position.y;
+
+    const int16_t *pacman_xs = particles_.getPacmanXs();
+    const int16_t *pacman_ys = particles_.getPacmanYs();
+
+    for (int particle = begin ; particle < end ; particle++)
+    {
+        double probability = pacman_likelihood_table_->getLikelihood(pacman_measurement_x - pacman_xs[particle],
+                                pacman_measurement_y - pacman_ys[particle]);
+
+        for (int ghost_index = 0 ; ghost_index < (int) ghosts_measurements->size() && probability != 0 ; ghost_index++)
+        {
+            int measurement_x = (*ghosts_measurements)[ghost_index].position.x;
+            int measurement_y = (*ghosts_measurements)[ghost_index].position.y;
+
+            int distance_x = particles_.getGhostXs(ghost_index)[particle] - pacman_xs[particle];
+            int distance_y = particles_.getGhostYs(ghost_index)[particle] - pacman_ys[particle];
+
+            probability *= ghost_distance_likelihood_table_->getLikelihood(measurement_x - distance_x, measurement_y - distance_y);
+        }
+
+        weights_[particle] = probability;
+    }
+}
+
+void ParticleFilter::observeAgents(const geometry_msgs::Pose& pacman_measurement, const std::vector< geometry_msgs::Pose >& ghosts_measurements)
+{
+    // weight each particle by all measurements of the tick, so particles are resampled only once
+    weights_.resize(particles_.size());
+    task_scheduler_.parallelFor(0, particles_.size(), util::PARTICLES_PER_BLOCK,
+                boost::bind(&ParticleFilter::weighAgentsParticles, this, &pacman_measurement, &ghosts_measurements, _1, _2));
+
+    // if no particles have probability of existing (float) show error message
+    if(!resampleParticles())
+        ROS_ERROR_STREAM("Error, all particles have a zero probability of being correct for this observation");
+
+    is_observed_ = true;
+}
+
 void ParticleFilter::estimateMap()
 {
-    std::vector<float> probability_line(map_height_, 0);
-    std::vector< std::vector<float> > pacman_probability_map(map_width_, probability_line);
-    std::vector< std::vector< std::vector<float> > > ghosts_probability_map(num_ghosts_, pacman_probability_map);
-    std::vector< std::vector<float> > food_probability_map(map_width_, probability_line);
-    std::vector< std::vector<float> > big_food_probability_map(map_width_, probability_line);
+    // indexed y * map_width_ + x
+    int num_cells = map_width_ * map_height_;
+    std::vector<float> pacman_probability_map(num_cells, 0);
+    std::vector< std::vector<float> > ghosts_probability_map(num_ghosts_, pacman_probability_map);
+    std::vector<float> food_probability_map(num_cells, 0);
+    std::vector<float> big_food_probability_map(num_cells, 0);
     std::vector<double> white_ghosts_time(num_ghosts_, 0);
     double score = 0;
 
-    double increase_amount = 1 / (double) game_particles_.size();
+    double increase_amount = 1 / (double) particles_.size();
 
     ROS_INFO_STREAM("increase_amount " << increase_amount);
 
-    for(std::vector< GameParticle >::reverse_iterator it = game_particles_.rbegin(); it != game_particles_.rend(); ++it)
+    // one column at a time, last particle first
+    const int *scores = particles_.getScores();
+    const int16_t *pacman_xs = particles_.getPacmanXs();
+    const int16_t *pacman_ys = particles_.getPacmanYs();
+    for (int particle = particles_.size() - 1 ; particle > -1 ; particle--)
     {
-        geometry_msgs::Pose pose;
-
-        score += it->getScore();
-        
-        pose = it->getPacmanPose();
-        pacman_probability_map[pose.position.y][pose.position.x] += increase_amount;
-
-        for(int i = 0 ; i < num_ghosts_ ; ++i)
-        {
-            pose = it->getGhostPose(i);
-            ghosts_probability_map[i][pose.position.y][pose.position.x] += increase_amount;
-        }
+        score += scores[particle];
+        pacman_probability_map[pacman_ys[particle] * map_width_ + pacman_xs[particle]] += increase_amount;
+    }
 
-        std::vector<int> white_ghosts_time_particle = it->getWhiteGhostsTime();
-        for(int i = white_ghosts_time.size() - 1 ; i > -1 ; i--)
+    for(int i = 0 ; i < num_ghosts_ ; ++i)
+    {
+        const int16_t *ghost_xs = particles_.getGhostXs(i);
+        const int16_t *ghost_ys = particles_.getGhostYs(i);
+        const int16_t *white_ghosts_times = particles_.getWhiteGhostsTimes(i);
+        for (int particle = particles_.size() - 1 ; particle > -1 ; particle--)
         {
-            white_ghosts_time[i] += white_ghosts_time_particle[i];
+            ghosts_probability_map[i][ghost_ys[particle] * map_width_ + ghost_xs[particle]] += increase_amount;
+            white_ghosts_time[i] += white_ghosts_times[particle];
         }
+    }
 
-        std::vector< std::vector<GameParticle::MapElements> > particle_map = it->getMap();
-        for (int i = map_height_ -1 ; i > -1  ; i--)
+    // only the set bits are visited, so eaten food costs nothing
+    int num_food_words = particles_.getNumberOfFoodWords();
+    for (int particle = particles_.size() - 1 ; particle > -1 ; particle--)
+    {
+        const uint64_t *food_bits = particles_.getFoodBits(particle);
+        const uint64_t *big_food_bits = particles_.getBigFoodBits(particle);
+        for (int word = 0 ; word < num_food_words ; word++)
         {
-            for (int j = 1 ; j < map_width_ - 1 ; j++)
-            {
-                if( particle_map[i][j] == GameParticle::FOOD )
-                    food_probability_map[i][j] += increase_amount;
-                else if( particle_map[i][j] == GameParticle::BIG_FOOD )
-                    big_food_probability_map[i][j] += increase_amount;
-            }
+            for (uint64_t bits = food_bits[word] ; bits ; bits &= bits - 1)
+                food_probability_map[layout_.getOpenCell(word * 64 + __builtin_ctzll(bits))] += increase_amount;
+            for (uint64_t bits = big_food_bits[word] ; bits ; bits &= bits - 1)
+                big_food_probability_map[layout_.getOpenCell(word * 64 + __builtin_ctzll(bits))] += increase_amount;
         }
     }
 
@@ -213,24 +277,27 @@ void ParticleFilter::estimateMap()
 
     for (int i = map_height_ -1 ; i > -1  ; i--) {
         for (int j = 1 ; j < map_width_ - 1 ; j++) {
-            if(pacman_max < pacman_probability_map[i][j])
+            int cell = i * map_width_ + j;
+            if(pacman_max < pacman_probability_map[cell])
             {
                 pacman_pose.position.x = j;
                 pacman_pose.position.y = i;
-                pacman_max = pacman_probability_map[i][j];
+                pacman_max = pacman_probability_map[cell];
             }
             for(int ghost_counter = 0; ghost_counter < num_ghosts_ ; ++ghost_counter)
             {
-                if(ghosts_max[ghost_counter] < ghosts_probability_map[ghost_counter][i][j])
+                if(ghosts_max[ghost_counter] < ghosts_probability_map[ghost_counter][cell])
                 {
                     ghosts_poses[ghost_counter].position.x = j;
                     ghosts_poses[ghost_counter].position.y = i;
-                    ghosts_max[ghost_counter] = ghosts_probability_map[ghost_counter][i][j];
+                    ghosts_max[ghost_counter] = ghosts_probability_map[ghost_counter][cell];
                 }
             }
-            if(food_probability_map[i][j] > util::PRINT_FOOD_MINIMUM)
+            if( layout_.isWall(j, i) )
+                continue;
+            if(food_probability_map[cell] > util::PRINT_FOOD_MINIMUM)
                 estimated_map_[i][j] = GameParticle::FOOD;
-            else if(big_food_probability_map[i][j] > util::PRINT_FOOD_MINIMUM)
+            else if(big_food_probability_map[cell] > util::PRINT_FOOD_MINIMUM)
                 estimated_map_[i][j] = GameParticle::BIG_FOOD;
             else
                 estimated_map_[i][j] = GameParticle::EMPTY;
@@ -255,26 +322,20 @@ void ParticleFilter::printGhostParticles(int ghost_index)
 
 void ParticleFilter::printPacmanOrGhostParticles(bool is_pacman, int ghost_index)
 {
-    GameParticle map = game_particles_[0];
-    int height = map.getHeight();
-    int width = map.getWidth();
+    int height = map_height_;
+    int width = map_width_;
 
-    std::vector<float> probability_line(height, 0);
-    std::vector< std::vector<float> > probability_map(width, probability_line);
+    std::vector<float> probability_line(width, 0);
+    std::vector< std::vector<float> > probability_map(height, probability_line);
 
-    double increase_amount = 1 / (double) game_particles_.size();
+    double increase_amount = 1 / (double) particles_.size();
 
     ROS_INFO_STREAM("increase_amount " << increase_amount);
 
-    for(std::vector< GameParticle >::reverse_iterator it = game_particles_.rbegin(); it != game_particles_.rend(); ++it) {
-        geometry_msgs::Pose pose;
-        if(is_pacman)
-            pose = it->getPacmanPose();
-        else
-            pose = it->getGhostPose(ghost_index);
-
-        probability_map[pose.position.y][pose.position.x] += increase_amount;
-    }
+    const int16_t *xs = is_pacman ? particles_.getPacmanXs() : particles_.getGhostXs(ghost_index);
+    const int16_t *ys = is_pacman ? particles_.getPacmanYs() : particles_.getGhostYs(ghost_index);
+    for (int particle = particles_.size() - 1 ; particle > -1 ; particle--)
+        probability_map[ys[particle]][xs[particle]] += increase_amount;
 
     for (int i = height -1 ; i > -1  ; i--) {
         std::ostringstream foo;
@@ -282,7 +343,7 @@ void ParticleFilter::printPacmanOrGhostParticles(bool is_pacman, int ghost_index
         foo << std::setprecision(0);
 
         for (int j = 1 ; j < width - 1 ; j++) {
-            if( map.getMapElement(j, i) == GameParticle::WALL)
+            if( layout_.isWall(j, i) )
                 foo << "###" << ' ';
             else
             {
@@ -311,7 +372,7 @@ void ParticleFilter::printMostProbableMap()
     for (int i = map_height_ -1 ; i > -1  ; i--) {
         std::ostringstream foo;
         for (int j = 1 ; j < map_width_ - 1 ; j++) {
-            if( walls_[i][j])
+            if( layout_.isWall(j, i) )
                 foo << "#" << ' ';
             else
             {
@@ -353,65 +414,24 @@ void ParticleFilter::resetNewObservation()
     is_observed_ = false;
 }
 
-std::map< std::pair<int, int>, int > ParticleFilter::calculateDistances(int x, int y)
-{
-    std::map< std::pair<int, int>, int > distances;
-
-    distances[std::make_pair(x, y)] = 0;
-
-    int current_distance = 0;
-    bool done = false;
-
-    GameParticle map = game_particles_[0];
-    std::vector< std::pair<int, int> > legal_positions = map.getLegalNextPositions(x, y);
-
-    while(!done)
-    {
-        done = true;
-        current_distance++;
-        std::vector< std::pair<int, int> > next_legal_positions;
-
-        for(std::vector< std::pair<int, int> >::reverse_iterator it = legal_positions.rbegin(); it != legal_positions.rend(); ++it)
-        {
-            if ( distances.find(*it) == distances.end() )
-            {
-                distances[*it] = current_distance;
-                done = false;
-
-                std::vector< std::pair<int, int> > temp_legal_positions = map.getLegalNextPositions(it->first, it->second);
-                next_legal_positions.reserve(next_legal_positions.size() + temp_legal_positions.size());
-                next_legal_positions.insert(next_legal_positions.end(), temp_legal_positions.begin(), temp_legal_positions.end());
-            }
-        }
-
-        legal_positions = next_legal_positions;
-    }
-    
-    return distances;
-}
-
 void ParticleFilter::precalculateAllDistances() {
     ROS_INFO_STREAM("Calculating all distances");
 
-    for (int i = 0 ; i < map_width_ ; i++)
+    std::vector<bool> open_cells (map_width_ * map_height_, false);
+    for (int j = 0 ; j < map_height_ ; j++)
     {
-        for (int j = 0 ; j < map_height_ ; j++)
-        {
-            if( !walls_[j][i] )
-            {
-                precalculated_distances_[std::make_pair(i, j)] = calculateDistances(i, j);
-            }
-        }
+        for (int i = 0 ; i < map_width_ ; i++)
+            open_cells[j * map_width_ + i] = !layout_.isWall(i, j);
     }
 
+    distance_matrix_ = DistanceMatrix(map_width_, map_height_, open_cells, DistanceMatrix::getDefaultCacheDirectory());
+
     ROS_INFO_STREAM("Pre calculated all distances");
 }
 
-std::map< std::pair<int, int>, int > ParticleFilter::getDistances(int x, int y)
+const DistanceMatrix& ParticleFilter::getDistanceMatrix()
 {
-    std::map< std::pair<int, int>, int > distances = precalculated_distances_[std::make_pair(x, y)];
-    
-    return distances;
+    return distance_matrix_;
 }
 
 geometry_msgs::Pose ParticleFilter::getEstimatedPacmanPose()
@@ -451,10 +471,10 @@ std::vector< std::vector<GameParticle::MapElements> > ParticleFilter::getEstimat
 
 std::vector< pacman_interface::PacmanAction > ParticleFilter::getLegalActions(int x, int y)
 {
-    return game_particles_[0].getLegalActions(x, y);
+    return layout_.getLegalActions(x, y);
 }
 
 std::vector< std::pair<int, int> > ParticleFilter::getLegalNextPositions(int x, int y)
 {
-    return game_particles_[0].getLegalNextPositions(x, y);
+    return layout_.getLegalNextPositions(x, y);
 }
\ No newline at end of file
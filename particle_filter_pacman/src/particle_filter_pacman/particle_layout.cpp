@@ -0,0 +1,206 @@
+#include "particle_filter_pacman/particle_layout.h"
+
+ParticleLayout::ParticleLayout()
+{
+    width_ = 0;
+    height_ = 0;
+    num_ghosts_ = 0;
+    pacman_start_cell_ = -1;
+}
+
+ParticleLayout::ParticleLayout(GameParticle& game_particle)
+{
+    width_ = game_particle.getWidth();
+    height_ = game_particle.getHeight();
+    num_ghosts_ = game_particle.getNumberOfGhosts();
+
+    int num_cells = width_ * height_;
+    walls_ = std::vector<bool> (num_cells, false);
+    open_cell_indexes_ = std::vector<int> (num_cells, -1);
+    initial_elements_ = std::vector<GameParticle::MapElements> (num_cells, GameParticle::WALL);
+
+    for (int cell = 0 ; cell < num_cells ; cell++)
+    {
+        initial_elements_[cell] = game_particle.getMapElement(cell % width_, cell / width_);
+        walls_[cell] = (initial_elements_[cell] == GameParticle::WALL);
+        if (!walls_[cell])
+        {
+            open_cell_indexes_[cell] = open_cells_.size();
+            open_cells_.push_back(cell);
+        }
+    }
+
+    geometry_msgs::Pose pacman_pose = game_particle.getPacmanPose();
+    pacman_start_cell_ = getCell(pacman_pose.position.x, pacman_pose.position.y);
+
+    // a new particle has every ghost in its spawn
+    for (int ghost_index = 0 ; ghost_index < num_ghosts_ ; ghost_index++)
+    {
+        geometry_msgs::Pose ghost_pose = game_particle.getGhostPose(ghost_index);
+        ghosts_spawn_cells_.push_back(getCell(ghost_pose.position.x, ghost_pose.position.y));
+    }
+
+    pacman_moves_ = std::vector<int> (num_cells * NUM_DIRECTIONS, -1);
+    ghost_moves_offsets_ = std::vector<int> (num_cells + 1, 0);
+
+    for (int cell = 0 ; cell < num_cells ; cell++)
+    {
+        ghost_moves_offsets_[cell] = ghost_moves_.size();
+        if (walls_[cell])
+            continue;
+
+        int x = cell % width_;
+        int y = cell / width_;
+
+        if (!isWall(x, y + 1))
+            pacman_moves_[cell * NUM_DIRECTIONS + NORTH] = getCell(x, y + 1);
+        if (!isWall(x, y - 1))
+            pacman_moves_[cell * NUM_DIRECTIONS + SOUTH] = getCell(x, y - 1);
+        if (!isWall(x - 1, y))
+            pacman_moves_[cell * NUM_DIRECTIONS + WEST] = getCell(x - 1, y);
+        if (!isWall(x + 1, y))
+            pacman_moves_[cell * NUM_DIRECTIONS + EAST] = getCell(x + 1, y);
+
+        std::vector< std::pair<int, int> > next_positions = getLegalNextPositions(x, y);
+        for(std::vector< std::pair<int, int> >::iterator it = next_positions.begin(); it != next_positions.end(); ++it)
+            ghost_moves_.push_back(getCell(it->first, it->second));
+    }
+    ghost_moves_offsets_[num_cells] = ghost_moves_.size();
+}
+
+ParticleLayout::~ParticleLayout()
+{
+    walls_.clear();
+    open_cell_indexes_.clear();
+    open_cells_.clear();
+    initial_elements_.clear();
+    ghosts_spawn_cells_.clear();
+    pacman_moves_.clear();
+    ghost_moves_offsets_.clear();
+    ghost_moves_.clear();
+}
+
+int ParticleLayout::getWidth() const
+{
+    return width_;
+}
+
+int ParticleLayout::getHeight() const
+{
+    return height_;
+}
+
+int ParticleLayout::getNumberOfGhosts() const
+{
+    return num_ghosts_;
+}
+
+int ParticleLayout::getNumberOfOpenCells() const
+{
+    return open_cells_.size();
+}
+
+int ParticleLayout::getCell(int x, int y) const
+{
+    return y * width_ + x;
+}
+
+bool ParticleLayout::isWall(int x, int y) const
+{
+    return walls_[y * width_ + x];
+}
+
+int ParticleLayout::getOpenCellIndex(int cell) const
+{
+    return open_cell_indexes_[cell];
+}
+
+int ParticleLayout::getOpenCell(int open_cell_index) const
+{
+    return open_cells_[open_cell_index];
+}
+
+GameParticle::MapElements ParticleLayout::getInitialElement(int cell) const
+{
+    return initial_elements_[cell];
+}
+
+int ParticleLayout::getPacmanStartCell() const
+{
+    return pacman_start_cell_;
+}
+
+int ParticleLayout::getGhostSpawnCell(int ghost_index) const
+{
+    return ghosts_spawn_cells_[ghost_index];
+}
+
+int ParticleLayout::getPacmanMove(int cell, Direction direction) const
+{
+    return pacman_moves_[cell * NUM_DIRECTIONS + direction];
+}
+
+int ParticleLayout::getNumberOfGhostMoves(int cell) const
+{
+    return ghost_moves_offsets_[cell + 1] - ghost_moves_offsets_[cell];
+}
+
+const int *ParticleLayout::getGhostMoves(int cell) const
+{
+    return &ghost_moves_[0] + ghost_moves_offsets_[cell];
+}
+
+std::vector< pacman_interface::PacmanAction > ParticleLayout::getLegalActions(int x, int y) const
+{
+    std::vector< pacman_interface::PacmanAction > legal_actions;
+
+    if(isWall(x, y))
+    {
+        return legal_actions;
+    }
+
+    pacman_interface::PacmanAction action;
+    if(!isWall(x, y + 1))
+    {
+        action.action = action.NORTH;
+        legal_actions.push_back(action);
+    }
+    if(!isWall(x, y - 1))
+    {
+        action.action = action.SOUTH;
+        legal_actions.push_back(action);
+    }
+    if(!isWall(x + 1, y))
+    {
+        action.action = action.EAST;
+        legal_actions.push_back(action);
+    }
+    if(!isWall(x - 1, y))
+    {
+        action.action = action.WEST;
+        legal_actions.push_back(action);
+    }
+
+    return legal_actions;
+}
+
+std::vector< std::pair<int, int> > ParticleLayout::getLegalNextPositions(int x, int y) const
+{
+    std::vector< std::pair<int, int> > legal_next_positions;
+
+    if(isWall(x, y))
+    {
+        return legal_next_positions;
+    }
+
+    if(!isWall(x, y + 1))
+        legal_next_positions.push_back(std::make_pair(x, y+1));
+    if(!isWall(x, y - 1))
+        legal_next_positions.push_back(std::make_pair(x, y-1));
+    if(!isWall(x + 1, y))
+        legal_next_positions.push_back(std::make_pair(x+1, y));
+    if(!isWall(x - 1, y))
+        legal_next_positions.push_back(std::make_pair(x-1, y));
+
+    return legal_next_positions;
+}
@@ -0,0 +1,148 @@
+#include "particle_filter_pacman/particle_resampler.h"
+
+#include <cmath>
+
+ParticleResampler::ParticleResampler(Method method)
+{
+    method_ = method;
+}
+
+ParticleResampler::~ParticleResampler()
+{
+    points_.clear();
+    residual_weights_.clear();
+}
+
+ParticleResampler::Method ParticleResampler::getMethod() const
+{
+    return method_;
+}
+
+void ParticleResampler::setMethod(Method method)
+{
+    method_ = method;
+}
+
+void ParticleResampler::generateSystematicPoints(int num_points, RandomStream& random)
+{
+    points_.resize(num_points);
+
+    double offset = random.getUniform();
+    for (int k = 0 ; k < num_points ; k++)
+        points_[k] = (k + offset) / num_points;
+}
+
+void ParticleResampler::generateStratifiedPoints(int num_points, RandomStream& random)
+{
+    points_.resize(num_points);
+    random.fillUniforms(&points_[0], num_points);
+
+    for (int k = 0 ; k < num_points ; k++)
+        points_[k] = (k + points_[k]) / num_points;
+}
+
+void ParticleResampler::generateMultinomialPoints(int num_points, RandomStream& random)
+{
+    points_.resize(num_points + 1);
+    random.fillUniforms(&points_[0], num_points + 1);
+
+    // partial sums of num_points + 1 exponentials, over their total, are sorted uniforms
+    double sum = 0;
+    for (int k = 0 ; k < num_points + 1 ; k++)
+    {
+        sum += -std::log(1.0 - points_[k]);
+        points_[k] = sum;
+    }
+    points_.pop_back();
+
+    for (int k = 0 ; k < num_points ; k++)
+        points_[k] /= sum;
+}
+
+void ParticleResampler::selectParents(const std::vector<double>& weights, double total_weight, std::vector<int>& parents)
+{
+    // a point rounding up to the total must not land on trailing particles without weight
+    int last_particle = weights.size() - 1;
+    while (last_particle > 0 && weights[last_particle] == 0)
+        last_particle--;
+
+    int particle = 0;
+    double cumulative_weight = weights[0];
+
+    for (std::vector<double>::iterator it = points_.begin(); it != points_.end(); ++it)
+    {
+        double target = *it * total_weight;
+        while (target >= cumulative_weight && particle < last_particle)
+        {
+            particle++;
+            cumulative_weight += weights[particle];
+        }
+        parents.push_back(particle);
+    }
+}
+
+bool ParticleResampler::resample(const std::vector<double>& weights, int num_samples, std::vector<int>& parents, RandomStream& random)
+{
+    parents.clear();
+
+    // summed in the same order selectParents accumulates them
+    double total_weight = 0;
+    for (std::vector<double>::const_iterator it = weights.begin(); it != weights.end(); ++it)
+        total_weight += *it;
+
+    if (total_weight <= 0 || num_samples <= 0)
+        return false;
+
+    parents.reserve(num_samples);
+
+    if (method_ == SYSTEMATIC)
+    {
+        generateSystematicPoints(num_samples, random);
+        selectParents(weights, total_weight, parents);
+    }
+    else if (method_ == STRATIFIED)
+    {
+        generateStratifiedPoints(num_samples, random);
+        selectParents(weights, total_weight, parents);
+    }
+    else if (method_ == MULTINOMIAL)
+    {
+        generateMultinomialPoints(num_samples, random);
+        selectParents(weights, total_weight, parents);
+    }
+    else
+    {
+        // floor(num_samples * weight) copies of each particle, then the rest drawn from what is left
+        int num_particles = weights.size();
+        std::vector<int> num_copies (num_particles, 0);
+        residual_weights_.resize(num_particles);
+
+        int num_drawn = 0;
+        double total_residual_weight = 0;
+        for (int particle = 0 ; particle < num_particles ; particle++)
+        {
+            double expected_copies = num_samples * weights[particle] / total_weight;
+            num_copies[particle] = std::floor(expected_copies);
+            num_drawn += num_copies[particle];
+
+            residual_weights_[particle] = expected_copies - num_copies[particle];
+            total_residual_weight += residual_weights_[particle];
+        }
+
+        if (num_drawn < num_samples && total_residual_weight > 0)
+        {
+            generateMultinomialPoints(num_samples - num_drawn, random);
+            selectParents(residual_weights_, total_residual_weight, parents);
+            for (std::vector<int>::iterator it = parents.begin(); it != parents.end(); ++it)
+                num_copies[*it]++;
+            parents.clear();
+        }
+
+        for (int particle = 0 ; particle < num_particles ; particle++)
+            parents.insert(parents.end(), num_copies[particle], particle);
+        // rounding can leave the copies one short or over
+        parents.resize(num_samples, parents.empty() ? 0 : parents.back());
+    }
+
+    return true;
+}
@@ -0,0 +1,377 @@
+#include "particle_filter_pacman/particle_store.h"
+
+#include "particle_filter_pacman/util_constants.h"
+
+#include <algorithm>
+
+ParticleStore::ParticleStore()
+{
+    layout_ = NULL;
+    num_particles_ = 0;
+    num_ghosts_ = 0;
+    num_open_cells_ = 0;
+    num_food_words_ = 0;
+}
+
+ParticleStore::ParticleStore(const ParticleLayout& layout, int num_particles)
+{
+    layout_ = &layout;
+    num_particles_ = num_particles;
+    num_ghosts_ = layout.getNumberOfGhosts();
+    num_open_cells_ = layout.getNumberOfOpenCells();
+
+    int width = layout.getWidth();
+    int pacman_cell = layout.getPacmanStartCell();
+    pacman_xs_ = std::vector<int16_t> (num_particles_, pacman_cell % width);
+    pacman_ys_ = std::vector<int16_t> (num_particles_, pacman_cell / width);
+
+    ghosts_xs_ = std::vector<int16_t> (num_ghosts_ * num_particles_);
+    ghosts_ys_ = std::vector<int16_t> (num_ghosts_ * num_particles_);
+    for (int ghost_index = 0 ; ghost_index < num_ghosts_ ; ghost_index++)
+    {
+        int spawn_cell = layout.getGhostSpawnCell(ghost_index);
+        std::fill(ghosts_xs_.begin() + ghost_index * num_particles_, ghosts_xs_.begin() + (ghost_index + 1) * num_particles_, spawn_cell % width);
+        std::fill(ghosts_ys_.begin() + ghost_index * num_particles_, ghosts_ys_.begin() + (ghost_index + 1) * num_particles_, spawn_cell / width);
+    }
+
+    white_ghosts_times_ = std::vector<int16_t> (num_ghosts_ * num_particles_, 0);
+    scores_ = std::vector<int> (num_particles_, 0);
+
+    // every particle starts sharing the layout food
+    num_food_words_ = (num_open_cells_ + 63) / 64;
+    FoodBits initial_foods (new std::vector<uint64_t> (2 * num_food_words_, 0));
+    for (int open_cell_index = 0 ; open_cell_index < num_open_cells_ ; open_cell_index++)
+    {
+        GameParticle::MapElements element = layout.getInitialElement(layout.getOpenCell(open_cell_index));
+        uint64_t bit = (uint64_t) 1 << (open_cell_index % 64);
+        if (element == GameParticle::FOOD)
+            (*initial_foods)[open_cell_index / 64] |= bit;
+        else if (element == GameParticle::BIG_FOOD)
+            (*initial_foods)[num_food_words_ + open_cell_index / 64] |= bit;
+    }
+
+    foods_ = std::vector< FoodBits > (num_particles_, initial_foods);
+}
+
+ParticleStore::~ParticleStore()
+{
+    pacman_xs_.clear();
+    pacman_ys_.clear();
+    ghosts_xs_.clear();
+    ghosts_ys_.clear();
+    white_ghosts_times_.clear();
+    scores_.clear();
+    foods_.clear();
+}
+
+int ParticleStore::size() const
+{
+    return num_particles_;
+}
+
+const int16_t *ParticleStore::getPacmanXs() const
+{
+    return &pacman_xs_[0];
+}
+
+const int16_t *ParticleStore::getPacmanYs() const
+{
+    return &pacman_ys_[0];
+}
+
+const int16_t *ParticleStore::getGhostXs(int ghost_index) const
+{
+    return &ghosts_xs_[ghost_index * num_particles_];
+}
+
+const int16_t *ParticleStore::getGhostYs(int ghost_index) const
+{
+    return &ghosts_ys_[ghost_index * num_particles_];
+}
+
+const int16_t *ParticleStore::getWhiteGhostsTimes(int ghost_index) const
+{
+    return &white_ghosts_times_[ghost_index * num_particles_];
+}
+
+const int *ParticleStore::getScores() const
+{
+    return &scores_[0];
+}
+
+int ParticleStore::getNumberOfFoodWords() const
+{
+    return num_food_words_;
+}
+
+const uint64_t *ParticleStore::getFoodBits(int particle) const
+{
+    return &(*foods_[particle])[0];
+}
+
+const uint64_t *ParticleStore::getBigFoodBits(int particle) const
+{
+    return &(*foods_[particle])[num_food_words_];
+}
+
+bool ParticleStore::hasFood(int particle, int open_cell_index) const
+{
+    return ( (*foods_[particle])[open_cell_index / 64] >> (open_cell_index % 64) ) & 1;
+}
+
+bool ParticleStore::hasBigFood(int particle, int open_cell_index) const
+{
+    return ( (*foods_[particle])[num_food_words_ + open_cell_index / 64] >> (open_cell_index % 64) ) & 1;
+}
+
+bool ParticleStore::hasAnyFood(int particle, int open_cell_index) const
+{
+    return hasFood(particle, open_cell_index) || hasBigFood(particle, open_cell_index);
+}
+
+void ParticleStore::unshareFoodBits()
+{
+    // runs on a single thread, so the share counts are exact, and a particle can only eat where pacman ends its move
+    for (int particle = 0 ; particle < num_particles_ ; particle++)
+    {
+        if (foods_[particle].unique())
+            continue;
+
+        int cell = layout_->getCell(pacman_xs_[particle], pacman_ys_[particle]);
+        bool can_eat = hasAnyFood(particle, layout_->getOpenCellIndex(cell));
+        for (int direction = 0 ; direction < ParticleLayout::NUM_DIRECTIONS && !can_eat ; direction++)
+        {
+            int next_cell = layout_->getPacmanMove(cell, (ParticleLayout::Direction) direction);
+            can_eat = next_cell >= 0 && hasAnyFood(particle, layout_->getOpenCellIndex(next_cell));
+        }
+
+        if (can_eat)
+            foods_[particle].reset(new std::vector<uint64_t> (*foods_[particle]));
+    }
+}
+
+std::vector<uint64_t>& ParticleStore::getOwnFoodBits(int particle)
+{
+    return *foods_[particle];
+}
+
+bool ParticleStore::isWithPacman(int particle, int ghost_index) const
+{
+    int k = ghost_index * num_particles_ + particle;
+    return ghosts_xs_[k] == pacman_xs_[particle] && ghosts_ys_[k] == pacman_ys_[particle];
+}
+
+void ParticleStore::sendToSpawn(int particle, int ghost_index)
+{
+    int k = ghost_index * num_particles_ + particle;
+    int spawn_cell = layout_->getGhostSpawnCell(ghost_index);
+    ghosts_xs_[k] = spawn_cell % layout_->getWidth();
+    ghosts_ys_[k] = spawn_cell / layout_->getWidth();
+    white_ghosts_times_[k] = 0;
+}
+
+void ParticleStore::movePacman(int particle, pacman_interface::PacmanAction action, RandomStream& random)
+{
+    int cell = layout_->getCell(pacman_xs_[particle], pacman_ys_[particle]);
+
+    float CHANCE_OF_ACTION_SUCCESS = util::CHANCE_OF_ACTION_SUCCESS;
+    float chance_of_other_moves = (1 - CHANCE_OF_ACTION_SUCCESS )/4.0;
+
+    float directions_probabilities[ParticleLayout::NUM_DIRECTIONS];
+    directions_probabilities[ParticleLayout::NORTH] = ( action.action == action.NORTH ) ? CHANCE_OF_ACTION_SUCCESS : chance_of_other_moves;
+    directions_probabilities[ParticleLayout::SOUTH] = ( action.action == action.SOUTH ) ? CHANCE_OF_ACTION_SUCCESS : chance_of_other_moves;
+    directions_probabilities[ParticleLayout::WEST] = ( action.action == action.WEST ) ? CHANCE_OF_ACTION_SUCCESS : chance_of_other_moves;
+    directions_probabilities[ParticleLayout::EAST] = ( action.action == action.EAST ) ? CHANCE_OF_ACTION_SUCCESS : chance_of_other_moves;
+    float stop_probability = ( action.action == action.STOP ) ? CHANCE_OF_ACTION_SUCCESS : chance_of_other_moves;
+
+    // moves into walls become stops, and the stop is listed last
+    int next_cells[ParticleLayout::NUM_DIRECTIONS + 1];
+    float next_cells_probabilities[ParticleLayout::NUM_DIRECTIONS + 1];
+    int num_next_cells = 0;
+    for (int direction = 0 ; direction < ParticleLayout::NUM_DIRECTIONS ; direction++)
+    {
+        int next_cell = layout_->getPacmanMove(cell, (ParticleLayout::Direction) direction);
+        if (next_cell < 0)
+        {
+            stop_probability += directions_probabilities[direction];
+            continue;
+        }
+        next_cells[num_next_cells] = next_cell;
+        next_cells_probabilities[num_next_cells] = directions_probabilities[direction];
+        num_next_cells++;
+    }
+    next_cells[num_next_cells] = cell;
+    next_cells_probabilities[num_next_cells] = stop_probability;
+    num_next_cells++;
+
+    double random_variable = random.getUniform();
+    double sum_probs = 0;
+
+    for (int k = num_next_cells - 1 ; k > -1 ; k--)
+    {
+        sum_probs += next_cells_probabilities[k];
+        if(sum_probs >= random_variable)
+        {
+            pacman_xs_[particle] = next_cells[k] % layout_->getWidth();
+            pacman_ys_[particle] = next_cells[k] / layout_->getWidth();
+
+            int open_cell_index = layout_->getOpenCellIndex(next_cells[k]);
+            uint64_t bit = (uint64_t) 1 << (open_cell_index % 64);
+            // if food, increase score
+            if(hasFood(particle, open_cell_index))
+            {
+                scores_[particle] += 10;
+                getOwnFoodBits(particle)[open_cell_index / 64] &= ~bit;
+            }
+            // if big food, start white ghosts time
+            else if(hasBigFood(particle, open_cell_index))
+            {
+                for (int ghost_index = 0 ; ghost_index < num_ghosts_ ; ghost_index++)
+                    white_ghosts_times_[ghost_index * num_particles_ + particle] = 38;
+                getOwnFoodBits(particle)[num_food_words_ + open_cell_index / 64] &= ~bit;
+            }
+            break;
+        }
+    }
+}
+
+void ParticleStore::moveGhost(int particle, int ghost_index, RandomStream& random)
+{
+    int k = ghost_index * num_particles_ + particle;
+    int cell = layout_->getCell(ghosts_xs_[k], ghosts_ys_[k]);
+
+    int random_variable = random.getInt(layout_->getNumberOfGhostMoves(cell));
+    int next_cell = layout_->getGhostMoves(cell)[random_variable];
+
+    ghosts_xs_[k] = next_cell % layout_->getWidth();
+    ghosts_ys_[k] = next_cell / layout_->getWidth();
+}
+
+void ParticleStore::moveGhosts(int particle, RandomStream& random)
+{
+    // last ghost first, as GameParticle does
+    for (int ghost_index = num_ghosts_ - 1 ; ghost_index > -1 ; ghost_index--)
+    {
+        int16_t& white_ghost_time = white_ghosts_times_[ghost_index * num_particles_ + particle];
+        double random_number_of_moves = random.getUniform();
+
+        if(white_ghost_time) // if white, change probabilities of moves
+        {
+            if( random_number_of_moves > util::CHANCE_OF_WHITE_GHOST_STOP )
+            {
+                random_number_of_moves -= util::CHANCE_OF_WHITE_GHOST_STOP;
+                moveGhost(particle, ghost_index, random);
+
+                // if eaten, go to initial position
+                if(isWithPacman(particle, ghost_index))
+                {
+                    sendToSpawn(particle, ghost_index);
+                    scores_[particle] += 500;
+                }
+
+                if(random_number_of_moves > util::CHANCE_OF_WHITE_GHOST_ONE_MOVE)
+                {
+                    moveGhost(particle, ghost_index, random);
+
+                    // if eaten, go to initial position
+                    if(isWithPacman(particle, ghost_index))
+                    {
+                        sendToSpawn(particle, ghost_index);
+                        scores_[particle] += 500;
+                    }
+                }
+            }
+        }
+        else // if not white, move normally
+        {
+            if( random_number_of_moves > util::CHANCE_OF_GHOST_STOP )
+            {
+                random_number_of_moves -= util::CHANCE_OF_GHOST_STOP;
+                moveGhost(particle, ghost_index, random);
+                // if kileed, drop score
+                if(isWithPacman(particle, ghost_index))
+                {
+                    scores_[particle] -= 1000;
+                }
+
+                if(random_number_of_moves > util::CHANCE_OF_GHOST_ONE_MOVE)
+                {
+                    moveGhost(particle, ghost_index, random);
+                    // if kileed, drop score
+                    if(isWithPacman(particle, ghost_index))
+                    {
+                        scores_[particle] -= 1000;
+                    }
+                }
+            }
+        }
+    }
+}
+
+void ParticleStore::checkIfDeadGhosts(int particle)
+{
+    for (int ghost_index = num_ghosts_ - 1 ; ghost_index > -1 ; ghost_index--)
+    {
+        if(white_ghosts_times_[ghost_index * num_particles_ + particle] && isWithPacman(particle, ghost_index))
+            sendToSpawn(particle, ghost_index);
+    }
+}
+
+void ParticleStore::move(int particle, pacman_interface::PacmanAction action, RandomStream& random)
+{
+    // count a step to white ghosts
+    for (int ghost_index = 0 ; ghost_index < num_ghosts_ ; ghost_index++)
+    {
+        int16_t& white_ghost_time = white_ghosts_times_[ghost_index * num_particles_ + particle];
+        if(white_ghost_time)
+            white_ghost_time--;
+    }
+
+    scores_[particle]--;
+
+    moveGhosts(particle, random);
+    movePacman(particle, action, random);
+
+    checkIfDeadGhosts(particle);
+}
+
+void ParticleStore::resampleColumn(std::vector<int16_t>& column, int num_rows, const std::vector<int>& parents)
+{
+    int num_new_particles = parents.size();
+    new_values_.resize(num_rows * num_new_particles);
+
+    for (int row = 0 ; row < num_rows ; row++)
+    {
+        const int16_t *values = &column[row * num_particles_];
+        int16_t *new_values = &new_values_[row * num_new_particles];
+        for (int particle = 0 ; particle < num_new_particles ; particle++)
+            new_values[particle] = values[parents[particle]];
+    }
+
+    column.swap(new_values_);
+}
+
+void ParticleStore::resample(const std::vector<int>& parents)
+{
+    int num_new_particles = parents.size();
+
+    resampleColumn(pacman_xs_, 1, parents);
+    resampleColumn(pacman_ys_, 1, parents);
+    resampleColumn(ghosts_xs_, num_ghosts_, parents);
+    resampleColumn(ghosts_ys_, num_ghosts_, parents);
+    resampleColumn(white_ghosts_times_, num_ghosts_, parents);
+
+    new_scores_.resize(num_new_particles);
+    for (int particle = 0 ; particle < num_new_particles ; particle++)
+        new_scores_[particle] = scores_[parents[particle]];
+    scores_.swap(new_scores_);
+
+    // only the food pointers are copied
+    new_foods_.resize(num_new_particles);
+    for (int particle = 0 ; particle < num_new_particles ; particle++)
+        new_foods_[particle] = foods_[parents[particle]];
+    foods_.swap(new_foods_);
+    new_foods_.clear();
+
+    num_particles_ = num_new_particles;
+}
@@ -28,13 +28,14 @@ std::vector<double> QLearningSimple::getFeatures(ParticleFilter *particle_filter
     std::vector< geometry_msgs::Pose > ghosts = particle_filter->getEstimatedGhostsPoses();
     std::vector< std::vector<GameParticle::MapElements> > map = particle_filter->getEstimatedMap();
 
-    std::map< std::pair<int, int>, int > distances = particle_filter->getDistances(pacman.position.x, pacman.position.y);
+    const DistanceMatrix& distance_matrix = particle_filter->getDistanceMatrix();
+    const uint16_t *distances = distance_matrix.getDistanceRow(pacman.position.x, pacman.position.y);
 
     // feature 1 / dist_closest_ghost
     int min_distance = util::INFINITE;
 
     for(std::vector< geometry_msgs::Pose >::reverse_iterator it = ghosts.rbegin(); it != ghosts.rend(); ++it) {
-        int distance = distances[std::make_pair(it->position.x, it->position.y)];
+        int distance = distance_matrix.distance(distances, it->position.x, it->position.y);
         if(distance != 0 && distance < min_distance)
         {
             min_distance = distance;
@@ -61,7 +62,7 @@ std::vector<double> QLearningSimple::getFeatures(ParticleFilter *particle_filter
         {
             if( map[j][i] == GameParticle::FOOD)
             {
-                int distance = distances[std::make_pair(i, j)];
+                int distance = distance_matrix.distance(distances, i, j);
                 if(distance < min_distance)
                 {
                     min_distance = distance;
@@ -4,6 +4,7 @@ const double util::DOUBLE_INFINITE = 10000000;
 const float util::PRINT_FOOD_MINIMUM = 0.5;
 
 const int util::NUMBER_OF_PARTICLES = 1000;
+const int util::PARTICLES_PER_BLOCK = 128;
 
 const float util::CHANCE_OF_ACTION_SUCCESS = 0.7;
 
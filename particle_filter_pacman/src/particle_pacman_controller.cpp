@@ -1,6 +1,10 @@
 #include "ros/ros.h"
 
 #include "particle_filter_pacman/particle_filter.h"
+#include "pacman_abstract_classes/random_stream.h"
+
+// seed of the match, 0 takes it from the clock
+uint64_t RANDOM_SEED = 0;
 
 int main(int argc, char **argv)
 {
@@ -10,6 +14,12 @@ int main(int argc, char **argv)
 
     ParticleFilter particle_filter;
 
+    if (!RANDOM_SEED)
+        RANDOM_SEED = time(NULL);
+    RandomStream::setMatchSeed(RANDOM_SEED);
+    // the filter drew its streams from the clock when it was built
+    particle_filter.reseed();
+
     while (ros::ok())
     {
         ros::spinOnce();
@@ -2,6 +2,7 @@
 #define BAYESIAN_GAME_STATE_H
 
 #include "q_learning_pacman/game_state.h"
+#include "pacman_abstract_classes/observation_engine.h"
 
 #include "pacman_msgs/AgentPose.h"
 #include "pacman_msgs/AgentPoseService.h"
@@ -23,6 +24,8 @@ class BayesianGameState : public GameState
     ros::ServiceServer pacman_observer_service_;
     ros::ServiceServer ghost_distance_observer_service_;
 
+    ObservationEngine ghost_distance_observation_engine_;
+
     void updatePacman(const geometry_msgs::Pose::ConstPtr& msg);
     void updateGhosts(const pacman_msgs::AgentPose::ConstPtr& msg);
 
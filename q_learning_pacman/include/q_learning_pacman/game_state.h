@@ -6,6 +6,9 @@
 
 #include "geometry_msgs/Pose.h"
 #include "pacman_msgs/PacmanAction.h"
+#include "pacman_abstract_classes/probability_grid.h"
+#include "q_learning_pacman/transition_matrix.h"
+#include "q_learning_pacman/white_ghost_timer.h"
 
 /**
  * Class that holds information on the pacman game.
@@ -16,9 +19,14 @@ class GameState
 {
   public:
     GameState();
-    ~GameState();
+    virtual ~GameState();
     typedef enum {EMPTY, FOOD, BIG_FOOD, WALL, ERROR} MapElements;
-    
+
+    // restores the state of the start of a match, keeping layout static data and services
+    virtual void reset();
+    // changes every time the state is observed, predicted, set or reset
+    unsigned long getStateVersion();
+
     void printMap();
     void printDeterministicMap();
 
@@ -30,19 +38,23 @@ class GameState
     std::vector< pacman_msgs::PacmanAction > getLegalActions(int x, int y);
     std::vector< std::pair<int, int> > getLegalNextPositions(int x, int y);
     std::vector< std::pair< float, std::pair<int, int> > > getNextPositionsForActionWithProbabilities(int x, int y, pacman_msgs::PacmanAction action);
+    const TransitionMatrix& getTransitionMatrix();
 
     int getNumberOfGhosts();
 
     geometry_msgs::Pose getPacmanPose();
     geometry_msgs::Pose getGhostPose(int ghost_index);
     std::vector< geometry_msgs::Pose > getGhostsPoses();
-    std::vector< std::vector<float> > getPacmanPoseMap();
-    std::vector< std::vector<float> > getGhostPoseMap(int ghost_index);
-    std::vector< std::vector< std::vector<float> > > getGhostsPoseMaps();
-    std::vector< std::vector<float> > getFoodMap();
-    std::vector< std::vector<float> > getBigFoodMap();
-    void setPacmanPoseMap(std::vector< std::vector<float> > pacman_pose_map);
-    void setGhostPoseMap(std::vector< std::vector<float> > ghost_pose_map, int ghost_index);
+    const ProbabilityGrid& getPacmanPoseMap();
+    const ProbabilityGrid& getGhostPoseMap(int ghost_index);
+    const std::vector< ProbabilityGrid >& getGhostsPoseMaps();
+    const ProbabilityGrid& getFoodMap();
+    const ProbabilityGrid& getBigFoodMap();
+    // replace a belief wholesale, states that index their beliefs rebuild the indexes
+    virtual void setPacmanPoseMap(const ProbabilityGrid& pacman_pose_map);
+    virtual void setGhostPoseMap(const ProbabilityGrid& ghost_pose_map, int ghost_index);
+    virtual void setFoodMap(const ProbabilityGrid& foods_map);
+    virtual void setBigFoodMap(const ProbabilityGrid& big_foods_map);
 
     static int MAX_DISTANCE;
 
@@ -57,20 +69,36 @@ class GameState
     int height_;
     int width_;
     std::vector< std::vector<MapElements> > map_;
+    // 1 for open cells and 0 for walls, shared by all probability grids
+    boost::shared_ptr< const std::vector<float> > open_cells_mask_;
+    // legal moves and pacman action probabilities of every cell, shared by all agents
+    TransitionMatrix transition_matrix_;
+    void buildTransitionMatrix();
 
     int num_ghosts_;
+    unsigned long state_version_;
     // probabilistic variables
-    std::vector< std::vector<float> > pacman_pose_map_;
-    std::vector< std::vector< std::vector<float> > > ghosts_poses_map_;
-    std::vector< std::vector<float> > foods_map_;
-    std::vector< std::vector<float> > big_foods_map_;
-    std::vector< std::vector<float> > probability_ghosts_white_;
+    ProbabilityGrid pacman_pose_map_;
+    std::vector< ProbabilityGrid > ghosts_poses_map_;
+    ProbabilityGrid foods_map_;
+    ProbabilityGrid big_foods_map_;
+    // probability each ghost turned white in each of the last ticks a big food lasts
+    WhiteGhostTimer white_ghost_timer_;
 
     std::vector< geometry_msgs::Pose > ghosts_spawn_poses_;
 
     // deterministic variables
     geometry_msgs::Pose pacman_pose_;
     std::vector< geometry_msgs::Pose > ghosts_poses_;
+
+    // state parsed from the layout, restored by reset
+    std::vector< std::vector<MapElements> > initial_map_;
+    ProbabilityGrid initial_pacman_pose_map_;
+    std::vector< ProbabilityGrid > initial_ghosts_poses_map_;
+    ProbabilityGrid initial_foods_map_;
+    ProbabilityGrid initial_big_foods_map_;
+    geometry_msgs::Pose initial_pacman_pose_;
+    std::vector< geometry_msgs::Pose > initial_ghosts_poses_;
 };
 
 #endif // GAME_STATE_H
\ No newline at end of file
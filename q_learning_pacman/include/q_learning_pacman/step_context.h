@@ -0,0 +1,88 @@
+#ifndef STEP_CONTEXT_H
+#define STEP_CONTEXT_H
+
+#include <vector>
+#include <stdint.h>
+
+#include "geometry_msgs/Pose.h"
+
+/**
+ * Class that holds what the learner and the behavior agent read from a game state in one tick:
+ * the most probable poses, the maze distances from the most probable pacman pose and the
+ * learner features. It is refreshed whenever the game state version changes, which every
+ * observe, predict and reset does.
+ *
+ * @author Tiago Pimentel Martins da Silva
+ */
+template <class GameStateType>
+class StepContext
+{
+  protected:
+    GameStateType *game_state_;
+    unsigned long state_version_;
+    geometry_msgs::Pose pacman_pose_;
+    std::vector< geometry_msgs::Pose > ghosts_poses_;
+    const uint16_t *pacman_distances_;
+    bool has_features_;
+    std::vector<double> features_;
+
+  public:
+    StepContext()
+    {
+        game_state_ = NULL;
+        state_version_ = 0;
+        pacman_distances_ = NULL;
+        has_features_ = false;
+    }
+
+    // returns true if the context had to be recalculated
+    bool update(GameStateType *game_state)
+    {
+        if (game_state == game_state_ && game_state->getStateVersion() == state_version_)
+            return false;
+
+        game_state_ = game_state;
+        state_version_ = game_state->getStateVersion();
+
+        pacman_pose_ = game_state->getMostProbablePacmanPose();
+        ghosts_poses_ = game_state->getMostProbableGhostsPoses();
+        pacman_distances_ = game_state->getDistanceMatrix().getDistanceRow(pacman_pose_.position.x, pacman_pose_.position.y);
+        has_features_ = false;
+
+        return true;
+    }
+
+    const geometry_msgs::Pose& getPacmanPose() const
+    {
+        return pacman_pose_;
+    }
+
+    const std::vector< geometry_msgs::Pose >& getGhostsPoses() const
+    {
+        return ghosts_poses_;
+    }
+
+    const uint16_t* getPacmanDistances() const
+    {
+        return pacman_distances_;
+    }
+
+    // features are calculated by the learner the first time they are needed in a tick
+    bool hasFeatures() const
+    {
+        return has_features_;
+    }
+
+    const std::vector<double>& getFeatures() const
+    {
+        return features_;
+    }
+
+    void setFeatures(const std::vector<double>& features)
+    {
+        features_ = features;
+        has_features_ = true;
+    }
+};
+
+#endif // STEP_CONTEXT_H
@@ -0,0 +1,46 @@
+#ifndef TRANSITION_MATRIX_H
+#define TRANSITION_MATRIX_H
+
+#include <vector>
+
+#include "pacman_abstract_classes/probability_grid.h"
+
+/**
+ * Class that holds the moves allowed in a layout as a compressed sparse row matrix.
+ * Row of cell c spans entries [getRowBegin(c), getRowEnd(c)): its legal neighbours followed
+ * by c itself, which is the last entry. Each pacman action has one probability per entry,
+ * so belief prediction is a sparse matrix vector product with no allocation.
+ * 
+ * @author Tiago Pimentel Martins da Silva
+ */
+class TransitionMatrix
+{
+  protected:
+    int num_cells_;
+    int num_actions_;
+    std::vector<int> row_offsets_;
+    std::vector<int> targets_;
+    std::vector< std::vector<float> > action_probabilities_;
+
+  public:
+    TransitionMatrix();
+    TransitionMatrix(int num_cells, int num_actions);
+    ~TransitionMatrix();
+
+    // rows must be added in cell order, neighbours first and the cell itself last
+    void addRow(const std::vector<int>& targets, const std::vector< std::vector<float> >& action_probabilities);
+
+    int getNumberOfCells() const;
+    int getRowBegin(int cell) const;
+    int getRowEnd(int cell) const;
+    int getNumberOfNeighbours(int cell) const;
+    int getTarget(int entry) const;
+    float getActionProbability(int action, int entry) const;
+
+    // next_map += T(action) * pose_map
+    void predictActionMove(const ProbabilityGrid& pose_map, int action, ProbabilityGrid& next_map) const;
+    // next_map += random walk that stays with stop_probability and moves uniformly otherwise
+    void predictRandomMove(const ProbabilityGrid& pose_map, float stop_probability, ProbabilityGrid& next_map) const;
+};
+
+#endif // TRANSITION_MATRIX_H
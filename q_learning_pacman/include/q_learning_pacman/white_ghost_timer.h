@@ -0,0 +1,46 @@
+#ifndef WHITE_GHOST_TIMER_H
+#define WHITE_GHOST_TIMER_H
+
+#include <vector>
+
+/**
+ * Class that holds, for each of the last ticks, the probability that each ghost turned white
+ * in that tick, in a fixed capacity circular buffer. Per ghost running totals make the
+ * probability of a ghost being white O(1), and decays are applied lazily through a per ghost
+ * scale factor, so neither advancing the timer nor scaling a ghost touches the whole buffer.
+ *
+ * @author Tiago Pimentel Martins da Silva
+ */
+class WhiteGhostTimer
+{
+  protected:
+    int capacity_;
+    int num_ghosts_;
+    // rows_[row * num_ghosts_ + ghost] times scales_[ghost] is the stored probability
+    std::vector<float> rows_;
+    std::vector<double> scales_;
+    std::vector<double> totals_;
+    int oldest_row_;
+
+    void rescale(int ghost_index);
+    void recalculateTotals();
+
+  public:
+    WhiteGhostTimer();
+    WhiteGhostTimer(int capacity, int num_ghosts);
+    ~WhiteGhostTimer();
+
+    void clear();
+
+    // drops the oldest tick and adds the probability every ghost turned white in the new one
+    void advance(float probability);
+    // multiplies every tick of a ghost by factor
+    void scale(int ghost_index, double factor);
+
+    int getCapacity() const;
+    double getProbability(int ghost_index) const;
+    // age 0 is the newest tick
+    float getProbability(int age, int ghost_index) const;
+};
+
+#endif // WHITE_GHOST_TIMER_H
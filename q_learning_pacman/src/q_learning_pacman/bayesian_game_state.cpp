@@ -1,9 +1,11 @@
 #include "q_learning_pacman/bayesian_game_state.h"
 
 #include "pacman_abstract_classes/util_functions.h"
+#include "pacman_abstract_classes/likelihood_table.h"
+#include <algorithm>
 
 
-BayesianGameState::BayesianGameState()
+BayesianGameState::BayesianGameState() : ghost_distance_observation_engine_(0.01)
 {
     //pacman_pose_subscriber_ = n_.subscribe<geometry_msgs::Pose>
                     ("/pacman/pacman_pose", 1000, boost::bind(&BayesianGameState::updatePacman, this, _1));
@@ -28,6 +30,8 @@ BayesianGameState::~BayesianGameState()
 
 void BayesianGameState::updateGhosts(const pacman_msgs::AgentPose::ConstPtr& msg)
 {
+    state_version_++;
+
     //ROS_INFO_STREAM("Observe Ghost");
     int ghost_index = msg->agent - 1;
     if(ghost_index == -1)
@@ -42,6 +46,8 @@ void BayesianGameState::updateGhosts(const pacman_msgs::AgentPose::ConstPtr& msg
 
 void BayesianGameState::updatePacman(const geometry_msgs::Pose::ConstPtr& msg)
 {
+    state_version_++;
+
     //ROS_INFO_STREAM("Observe Pacman");
     int measurement_x = msg->position.x;
     int measurement_y = msg->position.y;
@@ -50,114 +56,57 @@ void BayesianGameState::updatePacman(const geometry_msgs::Pose::ConstPtr& msg)
 
 void BayesianGameState::observePacman(int measurement_x, int measurement_y)
 {
+    state_version_++;
+
     //ROS_INFO_STREAM("pos x " << measurement_x << " y " << measurement_y);
     //printPacmanOrGhostPose(true, 0);
 
     float SD_PACMAN_MEASUREMENT = 0.01;
 
-    std::vector<float> pacman_pose_map_line (width_, 0);
-    std::vector< std::vector<float> > pacman_new_pose_map (height_, pacman_pose_map_line);
-    float sum_probabilities = 0.0;
+    // the gaussian is separable, so each cell likelihood is the product of its column and row weights
+    const LikelihoodTable& likelihood_table = LikelihoodTable::getTable(SD_PACMAN_MEASUREMENT, std::max(width_, height_));
+    std::vector<double> x_weights, y_weights;
+    likelihood_table.getAxisWeights(measurement_x, width_, x_weights);
+    likelihood_table.getAxisWeights(measurement_y, height_, y_weights);
 
-    for (int i = 0 ; i < width_ ; i++)
+    ProbabilityGrid likelihood_map (width_, height_);
+
+    for (int j = 0 ; j < height_ ; j++)
     {
-        for (int j = 0 ; j < height_ ; j++)
+        for (int i = 0 ; i < width_ ; i++)
         {
             if( map_[j][i] != WALL)
-            {
-                float old_probability_of_being_in_this_place = pacman_pose_map_[j][i];
-                float probability_of_place_given_z = util::getProbOfMeasurementGivenPosition(i, j, measurement_x, measurement_y, SD_PACMAN_MEASUREMENT);
-
-                //ROS_INFO_STREAM("" << random_probability);
-                pacman_new_pose_map[j][i] = probability_of_place_given_z * old_probability_of_being_in_this_place;
-
-                sum_probabilities += pacman_new_pose_map[j][i];
-            }
+                likelihood_map[j][i] = x_weights[i] * y_weights[j];
         }
     }
 
-    for (int i = 0 ; i < width_ ; i++)
+    pacman_pose_map_.multiply(likelihood_map);
+
+    if(!pacman_pose_map_.normalize())
     {
-        for (int j = 0 ; j < height_ ; j++)
-        {
-            if( map_[j][i] != WALL)
-            {
-                if(sum_probabilities != 0)
-                    pacman_new_pose_map[j][i] = pacman_new_pose_map[j][i]/sum_probabilities;
-                else
-                {
-                    ROS_WARN_STREAM_THROTTLE(1, "Probability 0 for pacman, redistributing");
-                    pacman_new_pose_map[j][i] = 1.0 / (float) ( height_ * width_ );
-                }
-            }
-        }
+        ROS_WARN_STREAM_THROTTLE(1, "Probability 0 for pacman, redistributing");
+        pacman_pose_map_.fillOpenCells(1.0 / (float) ( height_ * width_ ));
     }
 
-    pacman_pose_map_.clear();
-    pacman_pose_map_ = pacman_new_pose_map;
-
     //printPacmanOrGhostPose(true, 0);
 }
 
 void BayesianGameState::observeGhost(int measurement_x_dist, int measurement_y_dist, int ghost_index)
 {
-    /*if(ghost_index == 1) {
-        ROS_INFO_STREAM("pos x " << measurement_x_dist << " y " << measurement_y_dist);
-        printPacmanOrGhostPose(false, ghost_index);
-    }*/
-    double SD_GHOST_DIST_MEASUREMENT = 0.01;
-
-    std::vector< std::vector<float> > ghost_pose_map = ghosts_poses_map_[ghost_index];
+    state_version_++;
 
-    std::vector<float> ghost_pose_map_line (width_, 0);
-    std::vector< std::vector<float> > ghost_new_pose_map (height_, ghost_pose_map_line);
-    float sum_probabilities = 0.0;
+    ProbabilityGrid likelihood_map = ghost_distance_observation_engine_.getRelativeMeasurementLikelihood(
+                                pacman_pose_map_, measurement_x_dist, measurement_y_dist);
 
-    for (int i = 0 ; i < width_ ; i++)
-    {
-        for (int j = 0 ; j < height_ ; j++)
-        {
-            if( map_[j][i] != WALL)
-            {
-                float old_probability_of_being_in_this_place = ghost_pose_map[j][i];
-                for (int pacman_i = 0 ; pacman_i < width_ ; pacman_i++)
-                {
-                    for (int pacman_j = 0 ; pacman_j < height_ ; pacman_j++)
-                    {
-                        float probability_of_pacman = pacman_pose_map_[pacman_j][pacman_i];
-                        float probability_of_place_given_z = util::getProbOfMeasurementGivenPosition(i - pacman_i, j - pacman_j, measurement_x_dist, measurement_y_dist, SD_GHOST_DIST_MEASUREMENT);
-
-                        //ROS_INFO_STREAM("" << random_probability);
-                        ghost_new_pose_map[j][i] += probability_of_place_given_z * old_probability_of_being_in_this_place * probability_of_pacman;
-                    }
-                }
-                sum_probabilities += ghost_new_pose_map[j][i];
-            }
-        }
-    }
+    ProbabilityGrid& ghost_pose_map = ghosts_poses_map_[ghost_index];
+    ghost_pose_map.multiply(likelihood_map);
 
-    if(sum_probabilities == 0)
+    if(!ghost_pose_map.normalize())
     {
         ROS_WARN_STREAM("Probability 0 for ghost " << ghost_index << ", redistributing");
+        ghost_pose_map.fillOpenCells(1.0 / (float) ( height_ * width_ ));
     }
 
-    for (int i = 0 ; i < width_ ; i++)
-    {
-        for (int j = 0 ; j < height_ ; j++)
-        {
-            if( map_[j][i] != WALL)
-            {
-                if(sum_probabilities != 0)
-                    ghost_new_pose_map[j][i] = ghost_new_pose_map[j][i]/sum_probabilities;
-                else
-                    ghost_new_pose_map[j][i] = 1.0 / (float) ( height_ * width_ );
-            }
-        }
-    }
-
-    ghosts_poses_map_[ghost_index].clear();
-    ghosts_poses_map_[ghost_index] = ghost_new_pose_map;
-
     //if(ghost_index == 1)
     //    printPacmanOrGhostPose(false, ghost_index);
 }
@@ -187,79 +136,34 @@ bool BayesianGameState::observeAgent(pacman_msgs::AgentPoseService::Request &req
 
 void BayesianGameState::predictPacmanMove(pacman_msgs::PacmanAction action)
 {
+    state_version_++;
+
     ROS_INFO_STREAM("Predict pacman");
 
-    std::vector<float> pacman_pose_map_line (width_, 0);
-    std::vector< std::vector<float> > pacman_new_pose_map (height_, pacman_pose_map_line);
-    pacman_pose_map_line.clear();
+    ProbabilityGrid pacman_new_pose_map (width_, height_);
+    pacman_new_pose_map.setOpenCellsMask(open_cells_mask_);
 
-    for (int i = 0 ; i < width_ ; i++)
-    {
-        for (int j = 0 ; j < height_ ; j++)
-        {
-            if( map_[j][i] != WALL)
-            {
-                float probability_of_being_in_this_place = pacman_pose_map_[j][i];
-
-                std::vector< std::pair< float, std::pair<int, int> > > next_positions = getNextPositionsForActionWithProbabilities(i, j, action);
-
-                //ROS_INFO_STREAM("" << random_probability);
-
-                for(std::vector< std::pair< float, std::pair<int, int> > >::reverse_iterator it = next_positions.rbegin(); it != next_positions.rend(); ++it)
-                {
-                    /* std::cout << *it; ... */
-                    float probability_of_move = it->first;
-                    int x = it->second.first;
-                    int y = it->second.second;
-                    pacman_new_pose_map[y][x] += probability_of_move * probability_of_being_in_this_place;
-                }
-            }
-        }
-    }
+    transition_matrix_.predictActionMove(pacman_pose_map_, action.action, pacman_new_pose_map);
 
-    pacman_pose_map_.clear();
-    pacman_pose_map_ = pacman_new_pose_map;
+    pacman_pose_map_.swap(pacman_new_pose_map);
 }
 
 void BayesianGameState::predictGhostMove(int ghost_index)
 {
+    state_version_++;
+
     ROS_INFO_STREAM("Predict ghost " << ghost_index);
 
     double STOP_PROBABILITY = 0.2;
 
-    std::vector<float> ghost_pose_map_line (width_, 0);
-    std::vector< std::vector<float> > ghost_new_pose_map (height_, ghost_pose_map_line);
-
-    std::vector< std::vector<float> > ghost_pose_map = ghosts_poses_map_[ghost_index];
-
-    for (int i = 0 ; i < width_ ; i++)
-    {
-        for (int j = 0 ; j < height_ ; j++)
-        {
-            if( map_[j][i] != WALL)
-            {
-                float probability_of_being_in_this_place = ghost_pose_map[j][i];
-
-                std::vector< std::pair<int, int> > next_positions = getLegalNextPositions(i, j);
-                float random_probability = (1.0 - STOP_PROBABILITY)/next_positions.size();
-
-                ghost_new_pose_map[j][i] += STOP_PROBABILITY * probability_of_being_in_this_place;
+    ProbabilityGrid ghost_new_pose_map (width_, height_);
+    ghost_new_pose_map.setOpenCellsMask(open_cells_mask_);
 
-                //ROS_INFO_STREAM("" << random_probability);
+    const ProbabilityGrid& ghost_pose_map = ghosts_poses_map_[ghost_index];
 
-                for(std::vector< std::pair<int, int> >::reverse_iterator it = next_positions.rbegin(); it != next_positions.rend(); ++it)
-                {
-                    /* std::cout << *it; ... */
-                    int x = it->first;
-                    int y = it->second;
-                    ghost_new_pose_map[y][x] += random_probability * probability_of_being_in_this_place;
-                }
-            }
-        }
-    }
+    transition_matrix_.predictRandomMove(ghost_pose_map, STOP_PROBABILITY, ghost_new_pose_map);
 
-    ghosts_poses_map_[ghost_index].clear();
-    ghosts_poses_map_[ghost_index] = ghost_new_pose_map;
+    ghosts_poses_map_[ghost_index].swap(ghost_new_pose_map);
 }
 
 void BayesianGameState::predictGhostsMoves()
@@ -1,6 +1,7 @@
 #include "q_learning_pacman/game_state.h"
 
 #include <sstream>
+#include <algorithm>
 
 #include "pacman_msgs/PacmanMapInfo.h"
 
@@ -11,6 +12,7 @@ int GameState::MAX_DISTANCE = 1000000;
 GameState::GameState()
 {
     ROS_DEBUG_STREAM("Initialize game state");
+    state_version_ = 0;
     ros::ServiceClient initInfoClient = n_.serviceClient<pacman_msgs::PacmanMapInfo>("/pacman/initialize_map_layout");
     pacman_msgs::PacmanMapInfo initInfo;
 
@@ -28,18 +30,19 @@ GameState::GameState()
 
         pacman_msgs::MapLayout map_layout;
 
-        std::vector<float> pose_line (width_, 0);
-        pacman_pose_map_ = std::vector< std::vector<float> > (height_, pose_line);
+        pacman_pose_map_ = ProbabilityGrid(width_, height_);
+        foods_map_ = ProbabilityGrid(width_, height_);
+        big_foods_map_ = ProbabilityGrid(width_, height_);
 
         for (int i = 0 ; i < num_ghosts_; i++)
         {
-            ghosts_poses_map_.push_back( std::vector< std::vector<float> > (height_, pose_line));
+            ghosts_poses_map_.push_back( ProbabilityGrid(width_, height_) );
         }
 
+        boost::shared_ptr< std::vector<float> > open_cells_mask (new std::vector<float> (width_ * height_, 0));
+
         for (int i = 0 ; i < height_ ; i++) {
             std::vector<MapElements> map_line;
-            std::vector<float> foods_map_line;
-            std::vector<float> big_foods_map_line;
             for (int j = 0 ; j < width_ ; j++) {
                     float has_food = 0.0;
                     float has_big_food = 0.0;
@@ -93,21 +96,36 @@ GameState::GameState()
                         std::cout << "Error reading map";
                     }
 
-                    foods_map_line.push_back(has_food);
-                    big_foods_map_line.push_back(has_big_food);
+                    foods_map_[i][j] = has_food;
+                    big_foods_map_[i][j] = has_big_food;
+                    (*open_cells_mask)[i * width_ + j] = (map_line.back() == WALL) ? 0.0 : 1.0;
             }
             map_.push_back(map_line);
-            foods_map_.push_back(foods_map_line);
-            big_foods_map_.push_back(big_foods_map_line);
         }
 
         if (num_ghosts_ > num_initialized_ghost) {
             ghosts_poses_map_.erase(ghosts_poses_map_.begin() + num_initialized_ghost, ghosts_poses_map_.begin() + num_ghosts_);
             num_ghosts_ = num_initialized_ghost;
         }
+
+        open_cells_mask_ = open_cells_mask;
+        pacman_pose_map_.setOpenCellsMask(open_cells_mask_);
+        foods_map_.setOpenCellsMask(open_cells_mask_);
+        big_foods_map_.setOpenCellsMask(open_cells_mask_);
+        for(std::vector< ProbabilityGrid >::reverse_iterator it = ghosts_poses_map_.rbegin(); it != ghosts_poses_map_.rend(); ++it)
+            it->setOpenCellsMask(open_cells_mask_);
+
+        buildTransitionMatrix();
         
-        std::vector<float> probability_ghosts_white_line (num_ghosts_, 0);
-        probability_ghosts_white_ = std::vector< std::vector<float> > (40, probability_ghosts_white_line);
+        white_ghost_timer_ = WhiteGhostTimer(40, num_ghosts_);
+
+        initial_map_ = map_;
+        initial_pacman_pose_map_ = pacman_pose_map_;
+        initial_ghosts_poses_map_ = ghosts_poses_map_;
+        initial_foods_map_ = foods_map_;
+        initial_big_foods_map_ = big_foods_map_;
+        initial_pacman_pose_ = pacman_pose_;
+        initial_ghosts_poses_ = ghosts_poses_;
 
         ROS_DEBUG_STREAM("Map width " << width_ << " height " << height_ << " num ghosts " << num_ghosts_);
     }
@@ -128,33 +146,32 @@ GameState::~GameState()
         }
         map_.clear();
 
-        for(std::vector< std::vector<float> >::reverse_iterator it = pacman_pose_map_.rbegin(); 
-                            it != pacman_pose_map_.rend(); ++it) {
-            it->clear();
-        }
-        pacman_pose_map_.clear();
-
-        for(std::vector< std::vector< std::vector<float> > >::reverse_iterator it = ghosts_poses_map_.rbegin();
-                            it != ghosts_poses_map_.rend(); ++it) {
-            for(std::vector< std::vector<float> >::reverse_iterator it_2 = it->rbegin();
-                                it_2 != it->rend(); ++it_2) {
-                it_2->clear();
-            }
-            it->clear();
-        }
         ghosts_poses_map_.clear();
 
-        for(std::vector< std::vector<float> >::reverse_iterator it = foods_map_.rbegin(); it != foods_map_.rend(); ++it) {
-            it->clear();
-        }
-        foods_map_.clear();
+        ROS_DEBUG_STREAM("Game state destroyed");
+}
 
-        for(std::vector< std::vector<float> >::reverse_iterator it = big_foods_map_.rbegin(); it != big_foods_map_.rend(); ++it) {
-            it->clear();
-        }
-        big_foods_map_.clear();
+void GameState::reset()
+{
+    // the game node serves a single layout per process, so it does not need to be fetched again
+    map_ = initial_map_;
+    pacman_pose_map_ = initial_pacman_pose_map_;
+    ghosts_poses_map_ = initial_ghosts_poses_map_;
+    foods_map_ = initial_foods_map_;
+    big_foods_map_ = initial_big_foods_map_;
+    pacman_pose_ = initial_pacman_pose_;
+    ghosts_poses_ = initial_ghosts_poses_;
 
-        ROS_DEBUG_STREAM("Game state destroyed");
+    white_ghost_timer_.clear();
+
+    state_version_++;
+
+    ROS_DEBUG_STREAM("Game state reset");
+}
+
+unsigned long GameState::getStateVersion()
+{
+    return state_version_;
 }
 
 void GameState::printDeterministicMap()
@@ -206,6 +223,7 @@ void GameState::printMap()
     for (int i = height_ -1 ; i > -1  ; i--) {
         std::ostringstream foo;
         for (int j = 0 ; j < width_ ; j++) {
+                float food_probability = foods_map_.get(i * width_ + j);
                 bool is_ghost = false;
                 for(int ghost_counter = 0; ghost_counter < num_ghosts_ ; ghost_counter++)
                 {
@@ -220,14 +238,14 @@ void GameState::printMap()
                     continue;
                 else if (pacman_pose.position.x == j && pacman_pose.position.y == i)
                     foo << 'P';
-                else if (foods_map_[i][j] >= 0.3)
+                else if (food_probability >= 0.3)
                 {
                     //foo << "\033[48;2;0;0;0m" << '.' << "\033[0m";
-                    if (foods_map_[i][j] >= 0.9)
+                    if (food_probability >= 0.9)
                         foo << "\033[48;5;46m";
-                    else if (foods_map_[i][j] >= 0.5)
+                    else if (food_probability >= 0.5)
                         foo << "\033[48;5;30m";
-                    else if (foods_map_[i][j] >= 0.3)
+                    else if (food_probability >= 0.3)
                         foo << "\033[48;5;22m";
                     foo << '.' << "\033[0m";
                 }
@@ -257,7 +275,7 @@ void GameState::printFoodsMap()
                 foo << "###" << ' ';
             else
             {
-                int chance = foods_map_[i][j]*100;
+                int chance = foods_map_.get(i * width_ + j)*100;
 
                 if (chance >= 90)
                     foo << "\033[48;5;46m";
@@ -289,7 +307,7 @@ void GameState::printBigFoodsMap()
                 foo << "###" << ' ';
             else
             {
-                int chance = big_foods_map_[i][j]*100;
+                int chance = big_foods_map_.get(i * width_ + j)*100;
 
                 if (chance >= 90)
                     foo << "\033[48;5;46m";
@@ -311,7 +329,7 @@ void GameState::printBigFoodsMap()
 
 void GameState::printWhiteGhostsProbabilities()
 {
-    for(std::vector< std::vector<float> >::reverse_iterator it = probability_ghosts_white_.rbegin(); it != probability_ghosts_white_.rend(); ++it)
+    for(int age = 0; age < white_ghost_timer_.getCapacity() ; ++age)
     {
         std::ostringstream foo;
         foo << std::fixed;
@@ -319,7 +337,7 @@ void GameState::printWhiteGhostsProbabilities()
 
         for(int ghost_index = 0; ghost_index < num_ghosts_ ; ++ghost_index)
         {
-            int chance = (*it)[ghost_index] * 100;
+            int chance = white_ghost_timer_.getProbability(age, ghost_index) * 100;
 
             if (chance >= 70)
                 foo << "\033[48;5;46m";
@@ -352,9 +370,9 @@ void GameState::printPacmanOrGhostPose( bool is_pacman, int ghost_index)
                 int chance = -1;
 
                 if (is_pacman)
-                    chance = pacman_pose_map_[i][j]*100;
+                    chance = pacman_pose_map_.get(i * width_ + j)*100;
                 else
-                    chance = ghosts_poses_map_[ghost_index][i][j]*100;
+                    chance = ghosts_poses_map_[ghost_index].get(i * width_ + j)*100;
 
                 if (chance >= 90)
                     foo << "\033[48;5;46m";
@@ -499,44 +517,105 @@ std::vector< std::pair< float, std::pair<int, int> > > GameState::getNextPositio
     return legal_next_positions_with_probabilities;
 }
 
+void GameState::buildTransitionMatrix()
+{
+    int NUM_ACTIONS = 5;
+    transition_matrix_ = TransitionMatrix(width_ * height_, NUM_ACTIONS);
+
+    for (int j = 0 ; j < height_ ; j++)
+    {
+        for (int i = 0 ; i < width_ ; i++)
+        {
+            std::vector<int> targets;
+            std::vector< std::vector<float> > action_probabilities (NUM_ACTIONS);
+
+            if(map_[j][i] != WALL)
+            {
+                std::vector< std::pair<int, int> > next_positions = getLegalNextPositions(i, j);
+                for(std::vector< std::pair<int, int> >::iterator it = next_positions.begin(); it != next_positions.end(); ++it)
+                    targets.push_back(it->second * width_ + it->first);
+                targets.push_back(j * width_ + i);
+
+                for (int action_index = 0 ; action_index < NUM_ACTIONS ; action_index++)
+                {
+                    pacman_msgs::PacmanAction action;
+                    action.action = action_index;
+
+                    std::vector< std::pair< float, std::pair<int, int> > > moves = getNextPositionsForActionWithProbabilities(i, j, action);
+                    action_probabilities[action_index] = std::vector<float> (targets.size(), 0);
+
+                    for(std::vector< std::pair< float, std::pair<int, int> > >::iterator it = moves.begin(); it != moves.end(); ++it)
+                    {
+                        int target = it->second.second * width_ + it->second.first;
+                        for (int entry = 0 ; entry < (int) targets.size() ; entry++)
+                            if (targets[entry] == target)
+                                action_probabilities[action_index][entry] += it->first;
+                    }
+                }
+            }
+
+            transition_matrix_.addRow(targets, action_probabilities);
+        }
+    }
+}
+
+const TransitionMatrix& GameState::getTransitionMatrix()
+{
+    return transition_matrix_;
+}
+
 int GameState::getNumberOfGhosts()
 {
     return num_ghosts_;
 }
 
-std::vector< std::vector<float> > GameState::getPacmanPoseMap()
+const ProbabilityGrid& GameState::getPacmanPoseMap()
 {
     return pacman_pose_map_;
 }
 
-void GameState::setPacmanPoseMap(std::vector< std::vector<float> > pacman_pose_map)
+void GameState::setPacmanPoseMap(const ProbabilityGrid& pacman_pose_map)
 {
     pacman_pose_map_ = pacman_pose_map;
+    state_version_++;
 }
 
-std::vector< std::vector<float> > GameState::getGhostPoseMap(int ghost_index)
+const ProbabilityGrid& GameState::getGhostPoseMap(int ghost_index)
 {
     return ghosts_poses_map_[ghost_index];
 }
 
-std::vector< std::vector< std::vector<float> > > GameState::getGhostsPoseMaps()
+const std::vector< ProbabilityGrid >& GameState::getGhostsPoseMaps()
 {
     return ghosts_poses_map_;
 }
 
-std::vector< std::vector<float> > GameState::getFoodMap()
+const ProbabilityGrid& GameState::getFoodMap()
 {
     return foods_map_;
 }
 
-std::vector< std::vector<float> > GameState::getBigFoodMap()
+const ProbabilityGrid& GameState::getBigFoodMap()
 {
     return big_foods_map_;
 }
 
-void GameState::setGhostPoseMap(std::vector< std::vector<float> > ghost_pose_map, int ghost_index)
+void GameState::setGhostPoseMap(const ProbabilityGrid& ghost_pose_map, int ghost_index)
 {
     ghosts_poses_map_[ghost_index] = ghost_pose_map;
+    state_version_++;
+}
+
+void GameState::setFoodMap(const ProbabilityGrid& foods_map)
+{
+    foods_map_ = foods_map;
+    state_version_++;
+}
+
+void GameState::setBigFoodMap(const ProbabilityGrid& big_foods_map)
+{
+    big_foods_map_ = big_foods_map;
+    state_version_++;
 }
 
 geometry_msgs::Pose GameState::getPacmanPose()
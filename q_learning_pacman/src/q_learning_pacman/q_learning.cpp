@@ -27,18 +27,17 @@ std::vector<double> QLearning::getFeatures(BayesianGameState *game_state)
         features_[i] = 0;
     }
 
-    std::vector< std::vector<float> > pacman_pose = game_state->getPacmanPoseMap();
-    std::vector< std::vector< std::vector<float> > > ghosts_poses = game_state->getGhostsPoseMaps();
-    std::vector< std::vector<float> > foods = game_state->getFoodMap();
+    const ProbabilityGrid& pacman_pose = game_state->getPacmanPoseMap();
+    const std::vector< ProbabilityGrid >& ghosts_poses = game_state->getGhostsPoseMaps();
 
     double max_probability = -util::INFINITE;
     int pacman_x = 0;
     int pacman_y = 0;
 
     // get most probable pacman position
-    for(int i = pacman_pose.size() - 1; i > -1  ; --i)
+    for(int i = pacman_pose.getHeight() - 1; i > -1  ; --i)
     {
-        for(int j = pacman_pose[i].size() - 1; j > -1 ; --j)
+        for(int j = pacman_pose.getWidth() - 1; j > -1 ; --j)
         {
             if(max_probability < pacman_pose[i][j])
             {
@@ -55,12 +54,12 @@ std::vector<double> QLearning::getFeatures(BayesianGameState *game_state)
 
     for(int ghost_counter = num_ghosts - 1; ghost_counter > -1  ; --ghost_counter)
     {
-        std::vector< std::vector<float> > ghost_pose = ghosts_poses[ghost_counter];
+        const ProbabilityGrid& ghost_pose = ghosts_poses[ghost_counter];
         int distance = -1;
         max_probability = -util::INFINITE;
-        for(int i = ghost_pose.size() - 1; i > -1  ; --i)
+        for(int i = ghost_pose.getHeight() - 1; i > -1  ; --i)
         {
-            for(int j = ghost_pose[i].size() - 1; j > -1 ; --j)
+            for(int j = ghost_pose.getWidth() - 1; j > -1 ; --j)
             {
                 if(max_probability < ghost_pose[i][j])
                 {
@@ -0,0 +1,108 @@
+#include "q_learning_pacman/transition_matrix.h"
+
+TransitionMatrix::TransitionMatrix()
+{
+    num_cells_ = 0;
+    num_actions_ = 0;
+    row_offsets_.push_back(0);
+}
+
+TransitionMatrix::TransitionMatrix(int num_cells, int num_actions)
+{
+    num_cells_ = 0;
+    num_actions_ = num_actions;
+    row_offsets_.reserve(num_cells + 1);
+    row_offsets_.push_back(0);
+    action_probabilities_ = std::vector< std::vector<float> > (num_actions);
+}
+
+TransitionMatrix::~TransitionMatrix()
+{
+}
+
+void TransitionMatrix::addRow(const std::vector<int>& targets, const std::vector< std::vector<float> >& action_probabilities)
+{
+    targets_.insert(targets_.end(), targets.begin(), targets.end());
+    for (int action = 0 ; action < num_actions_ ; action++)
+        action_probabilities_[action].insert(action_probabilities_[action].end(),
+                    action_probabilities[action].begin(), action_probabilities[action].end());
+
+    row_offsets_.push_back(targets_.size());
+    num_cells_++;
+}
+
+int TransitionMatrix::getNumberOfCells() const
+{
+    return num_cells_;
+}
+
+int TransitionMatrix::getRowBegin(int cell) const
+{
+    return row_offsets_[cell];
+}
+
+int TransitionMatrix::getRowEnd(int cell) const
+{
+    return row_offsets_[cell + 1];
+}
+
+int TransitionMatrix::getNumberOfNeighbours(int cell) const
+{
+    int row_size = row_offsets_[cell + 1] - row_offsets_[cell];
+    return (row_size > 0) ? row_size - 1 : 0;
+}
+
+int TransitionMatrix::getTarget(int entry) const
+{
+    return targets_[entry];
+}
+
+float TransitionMatrix::getActionProbability(int action, int entry) const
+{
+    return action_probabilities_[action][entry];
+}
+
+void TransitionMatrix::predictActionMove(const ProbabilityGrid& pose_map, int action, ProbabilityGrid& next_map) const
+{
+    if (targets_.empty())
+        return;
+
+    const float *probabilities = pose_map.data();
+    float *next_probabilities = next_map.data();
+    const float *move_probabilities = &action_probabilities_[action][0];
+    const int *targets = &targets_[0];
+
+    for (int cell = 0 ; cell < num_cells_ ; cell++)
+    {
+        float probability_of_being_in_this_place = probabilities[cell];
+        if (probability_of_being_in_this_place == 0)
+            continue;
+
+        for (int entry = row_offsets_[cell] ; entry < row_offsets_[cell + 1] ; entry++)
+            next_probabilities[targets[entry]] += move_probabilities[entry] * probability_of_being_in_this_place;
+    }
+}
+
+void TransitionMatrix::predictRandomMove(const ProbabilityGrid& pose_map, float stop_probability, ProbabilityGrid& next_map) const
+{
+    if (targets_.empty())
+        return;
+
+    const float *probabilities = pose_map.data();
+    float *next_probabilities = next_map.data();
+    const int *targets = &targets_[0];
+
+    for (int cell = 0 ; cell < num_cells_ ; cell++)
+    {
+        float probability_of_being_in_this_place = probabilities[cell];
+        int row_end = row_offsets_[cell + 1];
+        if (probability_of_being_in_this_place == 0 || row_end == row_offsets_[cell])
+            continue;
+
+        float random_probability = (1.0 - stop_probability)/(row_end - row_offsets_[cell] - 1);
+
+        next_probabilities[cell] += stop_probability * probability_of_being_in_this_place;
+        for (int entry = row_offsets_[cell] ; entry < row_end - 1 ; entry++)
+            next_probabilities[targets[entry]] += random_probability * probability_of_being_in_this_place;
+    }
+}
@@ -0,0 +1,120 @@
+#include "q_learning_pacman/white_ghost_timer.h"
+
+#include <algorithm>
+
+WhiteGhostTimer::WhiteGhostTimer()
+{
+    capacity_ = 0;
+    num_ghosts_ = 0;
+    oldest_row_ = 0;
+}
+
+WhiteGhostTimer::WhiteGhostTimer(int capacity, int num_ghosts)
+{
+    capacity_ = capacity;
+    num_ghosts_ = num_ghosts;
+    rows_ = std::vector<float> (capacity * num_ghosts, 0);
+    scales_ = std::vector<double> (num_ghosts, 1.0);
+    totals_ = std::vector<double> (num_ghosts, 0.0);
+    oldest_row_ = 0;
+}
+
+WhiteGhostTimer::~WhiteGhostTimer()
+{
+    rows_.clear();
+    scales_.clear();
+    totals_.clear();
+}
+
+void WhiteGhostTimer::clear()
+{
+    std::fill(rows_.begin(), rows_.end(), 0);
+    std::fill(scales_.begin(), scales_.end(), 1.0);
+    std::fill(totals_.begin(), totals_.end(), 0.0);
+    oldest_row_ = 0;
+}
+
+void WhiteGhostTimer::advance(float probability)
+{
+    if (capacity_ == 0)
+        return;
+
+    float *row = &rows_[oldest_row_ * num_ghosts_];
+    for (int ghost_index = 0 ; ghost_index < num_ghosts_ ; ghost_index++)
+    {
+        totals_[ghost_index] -= row[ghost_index];
+        row[ghost_index] = probability / scales_[ghost_index];
+        totals_[ghost_index] += row[ghost_index];
+    }
+
+    oldest_row_ = (oldest_row_ + 1) % capacity_;
+
+    // once per lap, so rounding from the running subtractions never builds up
+    if (oldest_row_ == 0)
+        recalculateTotals();
+}
+
+void WhiteGhostTimer::scale(int ghost_index, double factor)
+{
+    if (factor == 1.0)
+        return;
+
+    if (factor <= 0)
+    {
+        for (int row = 0 ; row < capacity_ ; row++)
+            rows_[row * num_ghosts_ + ghost_index] = 0;
+        scales_[ghost_index] = 1.0;
+        totals_[ghost_index] = 0.0;
+        return;
+    }
+
+    scales_[ghost_index] *= factor;
+
+    // new ticks are stored divided by the scale, fold it in before they get too large for a float
+    double MIN_SCALE = 1e-6;
+    if (scales_[ghost_index] < MIN_SCALE)
+        rescale(ghost_index);
+}
+
+void WhiteGhostTimer::rescale(int ghost_index)
+{
+    double ghost_scale = scales_[ghost_index];
+    double total = 0.0;
+
+    for (int row = 0 ; row < capacity_ ; row++)
+    {
+        float& value = rows_[row * num_ghosts_ + ghost_index];
+        value = value * ghost_scale;
+        total += value;
+    }
+
+    scales_[ghost_index] = 1.0;
+    totals_[ghost_index] = total;
+}
+
+void WhiteGhostTimer::recalculateTotals()
+{
+    std::fill(totals_.begin(), totals_.end(), 0.0);
+
+    for (int row = 0 ; row < capacity_ ; row++)
+    {
+        for (int ghost_index = 0 ; ghost_index < num_ghosts_ ; ghost_index++)
+            totals_[ghost_index] += rows_[row * num_ghosts_ + ghost_index];
+    }
+}
+
+int WhiteGhostTimer::getCapacity() const
+{
+    return capacity_;
+}
+
+double WhiteGhostTimer::getProbability(int ghost_index) const
+{
+    return totals_[ghost_index] * scales_[ghost_index];
+}
+
+float WhiteGhostTimer::getProbability(int age, int ghost_index) const
+{
+    int row = (oldest_row_ + capacity_ - 1 - age) % capacity_;
+    return rows_[row * num_ghosts_ + ghost_index] * scales_[ghost_index];
+}
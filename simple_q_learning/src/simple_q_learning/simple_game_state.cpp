@@ -25,6 +25,8 @@ DeterministicGameState::~DeterministicGameState()
 
 void DeterministicGameState::observePacman(int measurement_x, int measurement_y)
 {
+    state_version_++;
+
     pacman_pose_.position.x = measurement_x;
     pacman_pose_.position.y = measurement_y;
 
@@ -33,6 +35,8 @@ void DeterministicGameState::observePacman(int measurement_x, int measurement_y)
 
 void DeterministicGameState::observeGhost(int measurement_x_dist, int measurement_y_dist, int ghost_index)
 {
+    state_version_++;
+
     ghosts_poses_[ghost_index].position.x = pacman_pose_.position.x + measurement_x_dist;
     ghosts_poses_[ghost_index].position.y = pacman_pose_.position.y + measurement_y_dist;
 }
@@ -66,6 +70,8 @@ bool DeterministicGameState::observeAgent(pacman_msgs::AgentPoseService::Request
 
 void DeterministicGameState::predictPacmanMove(pacman_msgs::PacmanAction action)
 {
+    state_version_++;
+
     ROS_DEBUG_STREAM("Predict pacman");
 
     // TODO: check if ok to predict stop when invalid
@@ -80,6 +86,8 @@ void DeterministicGameState::predictPacmanMove(pacman_msgs::PacmanAction action)
 
 void DeterministicGameState::predictGhostMove(int ghost_index)
 {
+    state_version_++;
+
     ROS_DEBUG_STREAM("Predict ghost " << ghost_index);
 
     // TODO: add things here
@@ -129,14 +137,14 @@ float DeterministicGameState::getClosestFoodDistance(pacman_msgs::PacmanAction a
     int new_x = new_pose.position.x;
     int new_y = new_pose.position.y;
 
-    std::map< std::pair<int, int>, int > distances = getDistances(new_x, new_y);
+    const uint16_t *distances = distance_matrix_.getDistanceRow(new_x, new_y);
 
     int min_dist = util::INFINITE;
 
     for (int i = 0 ; i < height_ ; i++) {
         for (int j = 0 ; j < width_ ; j++) {
             if(map_[i][j] == FOOD) {
-                int dist = distances[std::make_pair(j, i)];
+                int dist = distance_matrix_.distance(distances, j, i);
                 if (dist < min_dist) {
                     min_dist = dist;
                 }
@@ -164,14 +172,14 @@ int DeterministicGameState::getClosestGhostDistance(pacman_msgs::PacmanAction ac
     int new_x = new_pose.position.x;
     int new_y = new_pose.position.y;
 
-    std::map< std::pair<int, int>, int > distances = getDistances(new_x, new_y);
+    const uint16_t *distances = distance_matrix_.getDistanceRow(new_x, new_y);
 
     int min_dist = util::INFINITE;
 
     for(std::vector< geometry_msgs:: Pose >::reverse_iterator it = ghosts_poses_.rbegin();
                              it != ghosts_poses_.rend() ; ++it)
     {
-        int dist = distances[std::make_pair(it->position.x, it->position.y)];
+        int dist = distance_matrix_.distance(distances, it->position.x, it->position.y);
 
         if (dist < min_dist) {
             min_dist = dist;
@@ -218,63 +226,23 @@ int DeterministicGameState::getNumberOfGhostsOneStepAway(pacman_msgs::PacmanActi
     return number_ghost;
 }
 
-std::map< std::pair<int, int>, int > DeterministicGameState::calculateDistances(int x, int y)
-{
-    std::map< std::pair<int, int>, int > distances;
-
-    distances[std::make_pair(x, y)] = 0;
-
-    int current_distance = 0;
-    bool done = false;
-
-    std::vector< std::pair<int, int> > legal_positions = getLegalNextPositions(x, y);
-
-    while(!done)
-    {
-        done = true;
-        current_distance++;
-        std::vector< std::pair<int, int> > next_legal_positions;
-
-        for(std::vector< std::pair<int, int> >::reverse_iterator it = legal_positions.rbegin(); it != legal_positions.rend(); ++it)
-        {
-            if ( distances.find(*it) == distances.end() )
-            {
-                distances[*it] = current_distance;
-                done = false;
-
-                std::vector< std::pair<int, int> > temp_legal_positions = getLegalNextPositions(it->first, it->second);
-                next_legal_positions.reserve(next_legal_positions.size() + temp_legal_positions.size());
-                next_legal_positions.insert(next_legal_positions.end(), temp_legal_positions.begin(), temp_legal_positions.end());
-            }
-        }
-
-        legal_positions = next_legal_positions;
-    }
-    
-    return distances;
-}
-
 void DeterministicGameState::precalculateAllDistances()
 {
     ROS_DEBUG_STREAM("Pre-calculating all distances");
 
-    for (int i = 0 ; i < width_ ; i++)
+    std::vector<bool> open_cells (width_ * height_, false);
+    for (int j = 0 ; j < height_ ; j++)
     {
-        for (int j = 0 ; j < height_ ; j++)
-        {
-            if( map_[j][i] != WALL )
-            {
-                precalculated_distances_[std::make_pair(i, j)] = calculateDistances(i, j);
-            }
-        }
+        for (int i = 0 ; i < width_ ; i++)
+            open_cells[j * width_ + i] = map_[j][i] != WALL;
     }
 
+    distance_matrix_ = DistanceMatrix(width_, height_, open_cells, DistanceMatrix::getDefaultCacheDirectory());
+
     ROS_DEBUG_STREAM("Pre-calculated all distances");
 }
 
-std::map< std::pair<int, int>, int > DeterministicGameState::getDistances(int x, int y)
+const DistanceMatrix& DeterministicGameState::getDistanceMatrix()
 {
-    std::map< std::pair<int, int>, int > distances = precalculated_distances_[std::make_pair(x, y)];
-    
-    return distances;
-}
\ No newline at end of file
+    return distance_matrix_;
+}
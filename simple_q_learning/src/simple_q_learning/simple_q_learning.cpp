@@ -1,5 +1,6 @@
 #include "simple_q_learning/simple_q_learning.h"
 #include "pacman_abstract_classes/util_functions.h"
+#include "pacman_abstract_classes/random_stream.h"
 
 int SimpleQLearning::NUM_BEHAVIORS = 5;
 int SimpleQLearning::NUM_FEATURES = 7;
@@ -98,11 +99,12 @@ int SimpleQLearning::getBehavior(DeterministicGameState *game_state)
 
 int SimpleQLearning::getTrainingBehavior(DeterministicGameState *game_state)
 {
-    double random = rand() / (float) RAND_MAX;
+    RandomStream& random_stream = RandomStream::getThreadStream();
+    double random = random_stream.getUniform();
     if (random < exploration_rate_) {
         std::vector< pacman_msgs::PacmanAction > legalActions = game_state->getLegalActions();
 
-        int randomAction = rand() % legalActions.size();
+        int randomAction = random_stream.getInt(legalActions.size());
         int behavior = legalActions[randomAction].action;
 
         old_q_value_ = getQValue(game_state, behavior);
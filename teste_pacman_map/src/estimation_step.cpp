@@ -1,8 +1,11 @@
 #include <stdio.h>
 #include <math.h>
+#include <algorithm>
 
 #include "ros/ros.h"
 #include "teste_pacman_map/new_game_info.h"
+#include "pacman_abstract_classes/observation_engine.h"
+#include "pacman_abstract_classes/likelihood_table.h"
 
 #include "pacman_interface/AgentAction.h"
 #include "pacman_interface/AgentPose.h"
@@ -11,20 +14,9 @@
 static float SD_PACMAN_MEASUREMENT = 1.0;
 static float SD_GHOST_DIST_MEASUREMENT = 1.0;
 
-// TODO: Add food probabilities to observe and predict pacman movement
-
-float getProbOfMeasurementGivenPosition(int pos_x, int pos_y, int measurement_x, int measurement_y, double standard_deviation)
-{
-    // e^( (-1/2) * ( ( x - mean ) / std_deviation ) ^ 2 )
-    // e^( - ( ( ( x - mean_x ) ^ 2 + ( y - mean_y ) ^ 2 ) / ( 2 * std_deviation ) ) ^ 2 )
-
-    float diff_x = measurement_x - pos_x;
-    float diff_y = measurement_y - pos_y;
-
-    float exponencial_value = - (diff_x*diff_x + diff_y*diff_y) / (2*standard_deviation*standard_deviation);
+static ObservationEngine ghost_distance_observation_engine(SD_GHOST_DIST_MEASUREMENT);
 
-    return exp(exponencial_value);
-}
+// TODO: Add food probabilities to observe and predict pacman movement
 
 void observeGhost(NewGameInfo *game_info, int measurement_x_dist, int measurement_y_dist, int ghost_index)
 {
@@ -33,6 +25,8 @@ void observeGhost(NewGameInfo *game_info, int measurement_x_dist, int measuremen
 
     std::vector< std::vector<float> > pacman_pose_map = game_info->getPacmanPoseMap();
     std::vector< std::vector<float> > ghost_pose_map = game_info->getGhostPoseMap(ghost_index);
+    std::vector< std::vector<float> > likelihood_map = ghost_distance_observation_engine.getRelativeMeasurementLikelihood(
+                                pacman_pose_map, measurement_x_dist, measurement_y_dist);
 
     std::vector<float> ghost_pose_map_line (width, 0);
     std::vector< std::vector<float> > ghost_new_pose_map (height, ghost_pose_map_line);
@@ -44,18 +38,7 @@ void observeGhost(NewGameInfo *game_info, int measurement_x_dist, int measuremen
         {
             if( game_info->getMapElement(i, j) != NewGameInfo::WALL)
             {
-                float old_probability_of_being_in_this_place = ghost_pose_map[j][i];
-                for (int pacman_i = 0 ; pacman_i < width ; pacman_i++)
-                {
-                    for (int pacman_j = 0 ; pacman_j < height ; pacman_j++)
-                    {
-                        float probability_of_pacman = pacman_pose_map[pacman_j][pacman_i];
-                        float probability_of_place_given_z = getProbOfMeasurementGivenPosition(i - pacman_i, j - pacman_j, measurement_x_dist, measurement_y_dist, SD_GHOST_DIST_MEASUREMENT);
-
-                        //ROS_INFO_STREAM("" << random_probability);
-                        ghost_new_pose_map[j][i] += probability_of_place_given_z * old_probability_of_being_in_this_place * probability_of_pacman;
-                    }
-                }
+                ghost_new_pose_map[j][i] = likelihood_map[j][i] * ghost_pose_map[j][i];
                 sum_probabilities += ghost_new_pose_map[j][i];
             }
         }
@@ -88,6 +71,7 @@ void observePacman(NewGameInfo *game_info, int measurement_x, int measurement_y)
     int height = game_info->getHeight();
 
     std::vector< std::vector<float> > pacman_pose_map = game_info->getPacmanPoseMap();
+    const LikelihoodTable& likelihood_table = LikelihoodTable::getTable(SD_PACMAN_MEASUREMENT, 2 * std::max(width, height));
 
     std::vector<float> pacman_pose_map_line (width, 0);
     std::vector< std::vector<float> > pacman_new_pose_map (height, pacman_pose_map_line);
@@ -100,7 +84,7 @@ void observePacman(NewGameInfo *game_info, int measurement_x, int measurement_y)
             if( game_info->getMapElement(i, j) != NewGameInfo::WALL)
             {
                 float old_probability_of_being_in_this_place = pacman_pose_map[j][i];
-                float probability_of_place_given_z = getProbOfMeasurementGivenPosition(i, j, measurement_x, measurement_y, SD_PACMAN_MEASUREMENT);
+                float probability_of_place_given_z = likelihood_table.getLikelihood(measurement_x - i, measurement_y - j);
 
                 //ROS_INFO_STREAM("" << random_probability);
                 pacman_new_pose_map[j][i] = probability_of_place_given_z * old_probability_of_being_in_this_place;